@@ -0,0 +1,7 @@
+bench: the classic benchmark program that many BF compilers are measured with
+Prints the alphabet backwards and clears a cell ten million times for every letter
+
+>++[<+++++++++++++>-]<[[>+>+<<-]>[<+>-]++++++++
+[>++++++++<-]>.[-]<<>++++++++++[>++++++++++[>++
+++++++++[>++++++++++[>++++++++++[>++++++++++[>+
++++++++++[-]<-]<-]<-]<-]<-]<-]<-]++++++++++.
@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+# Compile and run every program of the corpus, check its output and
+# compare the results against the baseline of this machine.
+#
+# Usage: bench/bench.sh [--update]
+#
+# Every program runs BENCH_RUNS times (default 5) and the fastest run is
+# reported. A program is flagged as wrong when the checksum of its output
+# differs from the one in the corpus, and as a regression when its wall
+# time, cycles or instructions exceed the baseline by more than
+# BENCH_THRESHOLD percent (default 10). Counters that are missing from the
+# baseline or the run, because the kernel does not expose them, are not
+# compared, and a warning says so. Extra compiler options can be passed in
+# BENCH_FLAGS. The baseline is not part of the repository, as its numbers
+# only hold for the machine they were measured on: the first run stores
+# its results as the baseline, and so does --update.
+
+dir=$(dirname "$0")
+bfc=${BFC:-./bfc}
+measure=${MEASURE:-$dir/measure}
+runs=${BENCH_RUNS:-5}
+threshold=${BENCH_THRESHOLD:-10}
+baseline=$dir/baseline
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+grep -v -e '^#' -e '^$' "$dir/corpus" | while read -r name input _
+do
+    case $input in
+        -)
+            input=/dev/null
+            ;;
+        text:*)
+            bytes=${input#text:}
+            yes 'The quick brown fox jumps over the lazy dog; PACK MY BOX WITH FIVE DOZEN LIQUOR JUGS!' | head -c "$bytes" > "$work/text"
+            input=$work/text
+            ;;
+        *)
+            input=$dir/$input
+            ;;
+    esac
+
+    # shellcheck disable=SC2086
+    if ! "$bfc" $BENCH_FLAGS "$dir/$name.b" "$work/$name"
+    then
+        echo "$name: compilation failed" >&2
+        exit 1
+    fi
+
+    i=0
+    while [ $i -lt "$runs" ]
+    do
+        "$measure" -i "$input" -o "$work/$name.out" "$work/$name" || exit 1
+        i=$((i + 1))
+    done > "$work/$name.runs"
+
+    # Output is summarised by its checksum, the counters by their fastest run
+    sum=$(cksum < "$work/$name.out" | awk '{ print $1 }')
+    awk -v name="$name" -v sum="$sum" '
+        function lower(best, value) { return best == "" || value + 0 < best + 0 ? value : best }
+        { wall = lower(wall, $1); if ($2 != "-") cycles = lower(cycles, $2); if ($3 != "-") instrs = lower(instrs, $3) }
+        END { print name, sum, int(wall / 1000), cycles == "" ? "-" : cycles, instrs == "" ? "-" : instrs }
+    ' "$work/$name.runs"
+done > "$work/results" || exit 1
+
+if [ "$1" = "--update" ] || [ ! -f "$baseline" ]
+then
+    {
+        echo "# program wall(us) cycles instructions"
+        awk '{ print $1, $3, $4, $5 }' "$work/results"
+    } > "$baseline"
+    echo "Stored the results as the baseline in $baseline"
+fi
+
+awk -v threshold="$threshold" -v corpus="$dir/corpus" -v baseline="$baseline" '
+    function change(old, new)
+    {
+        if (old == "-" || new == "-" || old == 0)
+            return "-"
+        return sprintf("%+.1f%%", (new - old) * 100 / old)
+    }
+
+    function worse(old, new)
+    {
+        return old != "-" && new != "-" && new > old * (1 + threshold / 100)
+    }
+
+    /^#/ || /^$/ {
+        next
+    }
+
+    FILENAME == corpus {
+        sum[$1] = $3
+        next
+    }
+
+    FILENAME == baseline {
+        wall[$1] = $2; cycles[$1] = $3; instrs[$1] = $4
+        next
+    }
+
+    !header++ {
+        printf "%-10s %12s %8s %16s %8s %16s %8s  %s\n", "program", "wall(us)", "", "cycles", "", "instructions", "", "status"
+    }
+
+    {
+        status = "ok"
+        if ($2 != sum[$1])
+            status = "WRONG OUTPUT"
+        else if (!($1 in wall))
+            status = "new"
+        else if (worse(wall[$1], $3) || worse(cycles[$1], $4) || worse(instrs[$1], $5))
+            status = "REGRESSION"
+
+        # A counter missing on either side can not be compared, which must not pass silently
+        if (($1 in wall) && (cycles[$1] == "-" || $4 == "-"))
+            unchecked["cycles"] = 1
+        if (($1 in wall) && (instrs[$1] == "-" || $5 == "-"))
+            unchecked["instructions"] = 1
+
+        if (status == "WRONG OUTPUT" || status == "REGRESSION")
+            failed = 1
+
+        printf "%-10s %12s %8s %16s %8s %16s %8s  %s\n", $1, $3, change(wall[$1], $3), $4, change(cycles[$1], $4), $5, change(instrs[$1], $5), status
+    }
+
+    END {
+        fflush()
+        split("cycles instructions", counters, " ")
+        for (i = 1; i <= 2; ++i)
+            if (counters[i] in unchecked)
+                printf "warning: %s not compared, as the baseline or this run has none for some programs\n", counters[i] > "/dev/stderr"
+        exit failed
+    }
+' "$dir/corpus" "$baseline" "$work/results"
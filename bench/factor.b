@@ -0,0 +1,39 @@
+factor: reads decimal numbers below 256 one per line and prints their prime factors
+Trial division with a loop counting down the remainder for every candidate divisor
+
++[>>[-]<[-]+[>>[-],>>+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<---------->>>>+<<<<[->
+>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<<<<-------------------------------------
+-<[->>++++++++++<<]>>[-<<+>>]<[-<+>]>>>>->[-]]<[<<<<<<[-]>>>>>>-]<<->[-]]<[<<<<[
+-]<[-]>>>>>-]<<[-]<<]<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[<<<[->>>>>>>>>>+<
+<<<<<+<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]++++++++++<<<<<[-]>[-]>>>>[->>+<+<]
+>>[-<<+>>]<<<<<<<<[->>>>>>>-<<<<<+>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[
+->>>+<<+<]>>>[-<<<+>>>]<<<<<<<[-]<+>>>>>>>-]<<<<<<<<]>>>>>>>[-]<[-]++++++++++<<<
+[-]>[-]>>[->>+<+<]>>[-<<+>>]<<<<<<<[->>>>>>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[
+<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<[-]<+>>>>>-]<<<<<<<]>>>>>>[-]<[-]<<<[->>
+>>+<+<<<]>>>>[-<<<<+>>>>]<[<[-]+<<++++++++++++++++++++++++++++++++++++++++++++++
+++.------------------------------------------------>>>[-]]<<[->>>+<+<<]>>>[-<<<+
+>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<++++++++++++++++++++++++++++++++++++++++
+++++++++.------------------------------------------------>>[-]]<<<<+++++++++++++
++++++++++++++++++++++++++++++++++++.--------------------------------------------
+---->[-]>[-]<<[-]>>>[-]<<<<<++++++++++++++++++++++++++++++++++++++++++++++++++++
+++++++.[-]+>[-]<[->>>>+<<+<<]>>>>[-<<<<+>>>>]<<<<<<<<[->>>>>>>>+<+<<<<<<<]>>>>>>
+>>[-<<<<<<<<+>>>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>->[-]]<[<<<[-]
++>>>-]<]<[-]<<[-]>[<++<<<<[->>>>>>>>>>+<<<<+<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>
+>>>>]<<<<-[<<<<<<[->>>>>>>>>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<[
+-]>[-]<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<<[->-<<+>>>+<[->>>+<+<<]>
+>>[-<<<+>>>]<[<->[-]]<[<<<<<<<[->>>>>>>>+<<+<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<
+<<<[-]<+>>>>-]<<]>[-]+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<<<<<+>>>>>>->[-]]<[>++
+++++++++++++++++++++++++++++++.[-]<<<<<<<[->>>>>>>>>>>>>+<<<<<<+<<<<<<<]>>>>>>>>
+>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]++++++++++<<<<<[-]>[-]>>>>[->>+<+<]>>[-<<+>>]
+<<<<<<<<[->>>>>>>-<<<<<+>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]
+>>>[-<<<+>>>]<<<<<<<[-]<+>>>>>>>-]<<<<<<<<]>>>>>>>[-]<[-]++++++++++<<<[-]>[-]>>[
+->>+<+<]>>[-<<+>>]<<<<<<<[->>>>>>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<
+<[->>>+<<+<]>>>[-<<<+>>>]<<<<<[-]<+>>>>>-]<<<<<<<]>>>>>>[-]<[-]<<<[->>>>+<+<<<]>
+>>>[-<<<<+>>>>]<[<[-]+<<++++++++++++++++++++++++++++++++++++++++++++++++.-------
+----------------------------------------->>>[-]]<<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]
++>[-]]<[->>+<+<]>>[-<<+>>]<[<<++++++++++++++++++++++++++++++++++++++++++++++++.-
+----------------------------------------------->>[-]]<<<<+++++++++++++++++++++++
++++++++++++++++++++++++++.------------------------------------------------>[-]>[
+-]<<[-]>>>[-]<<<<<<<<<<<<<<<<[-]>>>>>>>[-<<<<<<<+>>>>>>>]>>>-]<<<[-]>[-]<<[-]<<<
+<<<[->>>>>>>>>>+<<<<+<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<<-]<<[-]>[-]]<+
++++++++++.[-]<[-]]<<<<<]
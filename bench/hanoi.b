@@ -0,0 +1,66 @@
+hanoi: solves the towers of hanoi for eight disks six hundred times and prints the moves of the last solution
+Every move is worked out from the move number alone by counting trailing zero bits and dividing by three
+
+>>>++++++[-<<<[-]+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++++++++++++++++++++++++++++++++[->[-]>[-]-[-<+[->>>>>>>>>>>>+<<<<<<<<<+<<<
+]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<<+[<<<<[->>>>>>>>>>+<+<<<<<<<<<]>>>
+>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]++<<<<<<<<[-]>[-]>>>>>>>[->>+<+<]>>[-<<+>>]<<<[->
+>-<<<<<<<<+>>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>
+>>]<<<<<<<<<<[-]<+>>>>>>>>>>-]<<<]>>[-]<[-]<+<<<<<<[->>>>>>>>+<+<<<<<<<]>>>>>>>>
+[-<<<<<<<<+>>>>>>>>]<[<<<<<<[-]<[-]<[-]>>>>>>>->[-]]<[<<<<<<<<+<[-]>>[-<<+>>]>>>
+>>>>-]<<<<<]>>>>>++<<<<[-]<<[-]>>>>>>[->>+<+<]>>[-<<+>>]<<<<<<<<<<<[->>>>>>>>>>-
+<<<<<<<+>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<
+<<<<<<<<[-]>>+>>>>>>-]<<<<<<<<<<<]>>>>>>>>>>[-]<[-]<<<<<<[-]>>>>>>+++<<<<<<<[-]>
+>>>[-]>>>[->>+<+<]>>[-<<+>>]<<<<<<[->>>>>-<<<<+>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[
+<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<<[-]<<<<+>>>>>>>>>-]<<<<<<]>>>>>[-]<[-]<
+<<<<<<[-]<[->>>>>>>>>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]++<<<<<<<<<
+[-]>>>>>>>[-]>>[->>+<+<]>>[-<<+>>]<<<[->>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<-
+>[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<[-]<<<<<<<+>>>>>>>>>>>-]<<<]>>[-]<[-]<<<<<
+<<<<[-]>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<[-]<[->>>>>>>+<+<<<<<<]>>>>>>>[-<
+<<<<<<+>>>>>>>]<[-<<<<<[-]++>>>>>[<<<<<[-]+>>>>>[-]]]<<<<[-]++<<[->>>>>>>+<+<<<<
+<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[-<<<<[-]+>>>>[<<<<[-]>>>>[-]]]<<->[-]]<[<<<[-]<[->
+>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[-<<<<[-]+>>>>[<<<<[-]++>>>>[-]]]<<<[-]+<<[
+->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[-<<<[-]++>>>[<<<[-]>>>[-]]]<-]<[-]<<<<<<
+<<<[-]>[-]>[-]>[-]>[-]>[-]>[-]>[-]>[-]<<<<<<<<<<]<<]>>>]<<[-]>[-]-[-<+[->>>>>>>>
+>>>>+<<<<<<<<<+<<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<<<<<+[<<<<[->>>>>>>>
+>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]++<<<<<<<<[-]>[-]>>>>>>>[->>+<+
+<]>>[-<<+>>]<<<[->>-<<<<<<<<+>>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->
+>>+<<+<]>>>[-<<<+>>>]<<<<<<<<<<[-]<+>>>>>>>>>>-]<<<]>>[-]<[-]<+<<<<<<[->>>>>>>>+
+<+<<<<<<<]>>>>>>>>[-<<<<<<<<+>>>>>>>>]<[<<<<<<[-]<[-]<[-]>>>>>>>->[-]]<[<<<<<<<<
++<[-]>>[-<<+>>]>>>>>>>-]<<<<<]>>>>>++<<<<[-]<<[-]>>>>>>[->>+<+<]>>[-<<+>>]<<<<<<
+<<<<<[->>>>>>>>>>-<<<<<<<+>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<
+<+<]>>>[-<<<+>>>]<<<<<<<<<[-]>>+>>>>>>-]<<<<<<<<<<<]>>>>>>>>>>[-]<[-]<<<<<<[-]>>
+>>>>+++<<<<<<<[-]>>>>[-]>>>[->>+<+<]>>[-<<+>>]<<<<<<[->>>>>-<<<<+>>>>>+<[->>>+<+
+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<<[-]<<<<+>>>>>>>>>-]<<
+<<<<]>>>>>[-]<[-]<<<<<<<[-]<[->>>>>>>>>>+<+<<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>
+>>>>>>]++<<<<<<<<<[-]>>>>>>>[-]>>[->>+<+<]>>[-<<+>>]<<<[->>-<<<+>>>>+<[->>>+<+<<
+]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<[-]<<<<<<<+>>>>>>>>>>>-]
+<<<]>>[-]<[-]<<<<<<<<<[-]>>>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<<<<[-]<[->>>>>>>+<
++<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[-<<<<<[-]++>>>>>[<<<<<[-]+>>>>>[-]]]<<<<[-]++
+<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[-<<<<[-]+>>>>[<<<<[-]>>>>[-]]]<<
+->[-]]<[<<<[-]<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[-<<<<[-]+>>>>[<<<<[-]++>
+>>>[-]]]<<<[-]+<<[->>>>>>+<+<<<<<]>>>>>>[-<<<<<<+>>>>>>]<[-<<<[-]++>>>[<<<[-]>>>
+[-]]]<-]<[-]++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++++.++++++++++++++++++++++++++++++++++.+++++++.-----------------.---------
+------------------------------------------------------------.+++++++++++++++++++
++++++++++++++++++++++++++++++++++++++++++++++++++.+++++.++++++++++.--------.----
+-----------------------------------------------------------------------.[-]<<<<<
+<<<+[->>>>>>>>>>>>>>+<<<<<<+<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>
+>>]++++++++++<<<<<[-]>[-]>>>>[->>+<+<]>>[-<<+>>]<<<<<<<<[->>>>>>>-<<<<<+>>>>>>+<
+[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<<<[-]<+>>>>>>>
+-]<<<<<<<<]>>>>>>>[-]<[-]++++++++++<<<[-]>[-]>>[->>+<+<]>>[-<<+>>]<<<<<<<[->>>>>
+>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<<[-
+]<+>>>>>-]<<<<<<<]>>>>>>[-]<[-]<<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<[-]+<<++++++++
+++++++++++++++++++++++++++++++++++++++++.---------------------------------------
+--------->>>[-]]<<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<++
+++++++++++++++++++++++++++++++++++++++++++++++.---------------------------------
+--------------->>[-]]<<<<++++++++++++++++++++++++++++++++++++++++++++++++.------
+------------------------------------------>[-]>[-]<<[-]>>>[-]<<<<<++++++++++++++
+++++++++++++++++++.+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++++.++++++++++++.---.--.--------------------------------------------------
+---------------------------.[-]<<+++++++++++++++++++++++++++++++++++++++++++++++
+++++++++++++++++++.>>++++++++++++++++++++++++++++++++.++++++++++++++++++++++++++
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++.-----.---------------
+----------------------------------------------------------------.[-]<+++++++++++
+++++++++++++++++++++++++++++++++++++++++++++++++++++++.>++++++++++.[-]<<<<<<<<<[
+-]>[-]>[-]>[-]>[-]>[-]>[-]>[-]>[-]<<<<<<<<<<]
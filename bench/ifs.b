@@ -0,0 +1,7 @@
+ifs: a while loop on a flag that ends right after an if on the same flag which clears it
+The if runs at most once so it has no test at its bottom and the while has to test the flag again
+Prints x and y after both count 250 times 250 times 250 iterations with x and y started at 48
+
+>>>>++++++++++++++++++++++++++++++++++++++++++++++++>+++++++++++++++++++++++++++
++++++++++++++++++++++<<<<<------[>------[>------[>+[>+<[>>+<<[-]]]<-]<-]<-
+]>>>>.>.<<<<<++++++++++.[-]
@@ -0,0 +1,18 @@
+loops: long running nested loops around a division whose inner loop runs a data dependent number of times
+Prints the final value of x after x becomes x plus x mod 7 plus 1 for 250000 times
+
+++++++++++++++++++++++++++++++++++++++++>>>+<<<[->[-]------[->[-]+++++++++++++++
+++++++++++[->[->>>>+<+<<<]>>>>[-<<<<+>>>>]+++++++<<<[-]>[-]>>[->>+<+<]>>[-<<+>>]
+<<<[->>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<
+<<<<[-]<+>>>>>-]<<<]>>[-]<[-]<<<[-]>[-<<+>>]<<+<]<]<]>>>[->>>>>>>>>+<<<<<<+<<<]>
+>>>>>>>>[-<<<<<<<<<+>>>>>>>>>]++++++++++<<<<<[-]>[-]>>>>[->>+<+<]>>[-<<+>>]<<<<<
+<<<[->>>>>>>-<<<<<+>>>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-
+<<<+>>>]<<<<<<<[-]<+>>>>>>>-]<<<<<<<<]>>>>>>>[-]<[-]++++++++++<<<[-]>[-]>>[->>+<
++<]>>[-<<+>>]<<<<<<<[->>>>>>-<<<+>>>>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>
+>+<<+<]>>>[-<<<+>>>]<<<<<[-]<+>>>>>-]<<<<<<<]>>>>>>[-]<[-]<<<[->>>>+<+<<<]>>>>[-
+<<<<+>>>>]<[<[-]+<<++++++++++++++++++++++++++++++++++++++++++++++++.------------
+------------------------------------>>>[-]]<<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]+>[-]
+]<[->>+<+<]>>[-<<+>>]<[<<++++++++++++++++++++++++++++++++++++++++++++++++.------
+------------------------------------------>>[-]]<<<<++++++++++++++++++++++++++++
+++++++++++++++++++++.------------------------------------------------>[-]>[-]<<[
+-]>>>[-]<<<<<++++++++++.[-]
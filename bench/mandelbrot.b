@@ -0,0 +1,88 @@
+mandelbrot: draws the mandelbrot set in ASCII art with up to 250 iterations for every point
+Fixed point with five fraction bits in sign and magnitude cells and products by repeated addition
+
+>>>>>>>>>>>>>>>>>>[-]+>>>[-]++++++++++++++++++++++++++++++++++++>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>[-]+++++++++++++++++++++++++[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<[-]+>>>[-]++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-]++++++++++++++++++++++++++++++++++++++++++++++
+++++++++++++++++++++++++++++++++++[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<[-]>>>[-]>>>[-]>>>[-]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-]>>>>>>[-]<<<[-]---
+--->>>>>>[-]+[<<<<<<<<<<<<<<<<<<<<<[-]>>>[-]++++++++++++++++>>>[-]--------------
+--------------------------------------------------------------------------------
+--------------------------------->>>>>>>>>>>>>>>>>>[-]<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+>>>+<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<[->[-]<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>+>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<[-<<<<<<<<<<<<<<<<
+<<<<<<->+<[>-]>[-<++++++++++++++++++++++++++++++++>>>>+<[-<<<<<<+>>>>>>>-]>[->]<
+<<]>>>>>>>>>>>>>>>>>>>>]<]<<<<<<<<<<<<<<<<<<<<<[-]>>>[-]<<<<<[-]>>[-]+++++++++++
++++++>>>[-]---------------------------------------------------------------------
+---------------------------------------------------------->>>>>>>>>>>>>>>>>>[-]<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>+>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<[->[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+>>+<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>]<<[-<<<<<<<<<<<<<<<<<<<<<<->+<[>-]>[-<+++++++++++++++++++++++++++++
++++>>>>+<[-<<<<<+>>>>>>-]>[->]<<<]>>>>>>>>>>>>>>>>>>>>]<]<<<<<<<<<<<<<<<<<<<<<[-
+]>>>[-]>>>[-]+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++>>>>>>>>>>>>>>>>>[-
+]<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>+>+<<<<<<<<<<<<<<<<<<<<<<
+<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>
+>>>>>>>>>>]<[-<<<<<<<<<<<<<<<<+<[->-]>[->>[-]+<]>>>>>>>>>>>>>>>][-]<<<<<<<<<<<<<
+<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>+>+<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>
+>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>]<[-<<<<<<
+<<<<<<<<<<+<[->-]>[->>[-]+<]>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<[-]>>>>+<[>>>>>>>>>
+[-]<<<<<<<<<<<<<<<<<<<<<[-]>[-]>>>>>>>>>>>>-]>[-<<<<<<<<<<<[-]>[-]++++++++>>>>>>
+>>>>>>>>>>>>>>>[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>]<<<[->[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<[-<<<<<<<<
+<<<<<<<<<<<<<<->+<[>-]>[-<++++++++++++++++<+>>>]>>>>>>>>>>>>>>>>>>>>]<]<<<<<<<<<
+<<<<<<<<<<<<[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+<[>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<
+<<<<<<<<<<<<<<<<-]>[->]>>>>>+<[>>>>>>>>>>>>>>>>>>>+<[->-]>[-<+>>]<<<<<<<<<<<<<<<
+<<<<-]>[->]<<[-]>>>[-]>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>
+>>>>>>>>]<<<<<<<<<<<<<<<<<<<<+<[>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>
+>>>>>>]<<<<<<<<<<<<<<-]>[->>>>>>>>>>>>>>[-]<<<<<<<<<<<<<]>>>>>>>>>>>>>[-]<<<<<<[
+->>>>>>+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]<<<<<<[->>>>>>+>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-<<+<[<<<<<<<<<<<<<<<<<+<[>>>+<<-]>[->>>+<
+[->-]>[-<<<<+>>>+>>]<<<]>>>>>>>>>>>>>>>>>-]>[-<<<<<<<<<<<<<<<<<<+<[>>>->+<[>-]>[
+-<<<<->>>>>]<<<<-]>[->>+<]>>>>>>>>>>>>>>>>>>]>]<<<[-]<<<<<<<<<<<<<<<<<<<<<<<<[-]
+>>>[-]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>
+>>>>]>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<+<[>>>+<<-]>[->>>+<[->-]>[-<<<<+>>>+>>]<<<]>
+>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<[-]<<<<<<<<<<<<[->>>>>>>>>>>>+>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]<<<<<<<<<<<<[->>>>
+>>>>>>>>+>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-<<+<[<<
+<<<<<<<<<<<<<<<<<<<<<+<[>>>+<<-]>[->>>+<[->-]>[-<<<<+>>>+>>]<<<]>>>>>>>>>>>>>>>>
+>>>>>>>-]>[-<<<<<<<<<<<<<<<<<<<<<<<<+<[>>>->+<[>-]>[-<<<<->>>>>]<<<<-]>[->>+<]>>
+>>>>>>>>>>>>>>>>>>>>>>]>]<<<[-]>>>>>>>>>>>>>>>>>>>>>>+<<<->+<[>-]>[->>>>>[-]<<<<
+]<<<]>>>>>>>]<<<<<<[-]>>>>>>>>>>>>>[-]++++++++++++++++++++++++++++++++<<<<<<<<<+
+<[->>>>>>>>>>++++++++++++++<<<<<<<<<-]>[->]<+<[->>>>>>>>>>--<<<<<<<<<-]>[->]<+<[
+->>>>>>>>>>++++++++++++++<<<<<<<<<-]>[->]<+<[->>>>>>>>>>+<<<<<<<<<-]>[->]<+<[->>
+>>>>>>>>++<<<<<<<<<-]>[->]<+<[->>>>>>>>>>------------------<<<<<<<<<-]>[->]<+<[-
+>>>>>>>>>>-<<<<<<<<<-]>[->]<+<[->>>>>>>>>>-----<<<<<<<<<-]>[->]<+<[->>>>>>>>>>--
+<<<<<<<<<-]>[->]<<[-]<<<<<+<[>-]>[->>>>>>>>>>>>>>>[-]+++++++++++++++++++++++++++
++++++++++++++++++++++++++++++++++++++<<<<<<<<<<<<<<]<<[-]>>>>>>>>>>>>>>>>.<<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+<[>>>->+<[>-]>[-<<<<->>>>>]<<<<-]>[->>+<]>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]>>>>>[-]++++++++++.<<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<+<[>>>->+<[>-]>[-<<<<->>>>>]<<<<-]>[->>+<]<+<[>>>->+<[>-]>[-<<<<->>
+>>>]<<<<-]>[->>+<]<+<[>>>->+<[>-]>[-<<<<->>>>>]<<<<-]>[->>+<]>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>]
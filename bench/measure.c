@@ -0,0 +1,183 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+/* Run a program once and report its wall time, cycles and instructions
+ *
+ * Usage: measure [-i <input file>] [-o <output file>] <program> [<args>...]
+ *
+ * Prints one line with the wall time in nanoseconds, followed by the
+ * number of user space cycles and instructions the program retired, or
+ * a dash where the counters are not available (anything but Linux, or
+ * perf events disabled by kernel.perf_event_paranoid).
+ */
+
+
+#ifdef __linux__
+/* Open a counter for the child, started when it calls exec() */
+static int open_counter(pid_t pid, uint64_t config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+}
+#endif
+
+
+/* Print a counter value, or a dash if it could not be read */
+static void print_counter(int fd)
+{
+    uint64_t value;
+
+    if (fd >= 0 && read(fd, &value, sizeof(value)) == sizeof(value))
+    {
+        printf(" %llu", (unsigned long long) value);
+    }
+    else
+    {
+        printf(" -");
+    }
+}
+
+
+/* Replace a standard stream of the child with a file */
+static void redirect(const char* path, int flags, int target)
+{
+    int fd = open(path, flags, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Could not open file '%s': %s\n", path, strerror(errno));
+        _exit(127);
+    }
+
+    dup2(fd, target);
+    close(fd);
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* input = NULL;
+    const char* output = NULL;
+    int counters[2] = { -1, -1 };
+    int gate[2];
+    struct timespec start, end;
+    int status;
+    int opt;
+    pid_t pid;
+
+    while ((opt = getopt(argc, argv, "+i:o:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'i':
+                input = optarg;
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            default:
+                return 2;
+        }
+    }
+
+    if (optind == argc)
+    {
+        fprintf(stderr, "Usage: %s [-i <input file>] [-o <output file>] <program> [<args>...]\n", argv[0]);
+        return 2;
+    }
+
+    // The child waits on the pipe until its counters are set up
+    if (pipe(gate) != 0)
+    {
+        fprintf(stderr, "Could not create pipe: %s\n", strerror(errno));
+        return 1;
+    }
+
+    pid = fork();
+    if (pid < 0)
+    {
+        fprintf(stderr, "Could not fork: %s\n", strerror(errno));
+        return 1;
+    }
+
+    if (pid == 0)
+    {
+        char ready;
+
+        close(gate[1]);
+        if (read(gate[0], &ready, 1) < 0)
+        {
+            _exit(127);
+        }
+        close(gate[0]);
+
+        if (input != NULL)
+        {
+            redirect(input, O_RDONLY, STDIN_FILENO);
+        }
+
+        if (output != NULL)
+        {
+            redirect(output, O_WRONLY | O_CREAT | O_TRUNC, STDOUT_FILENO);
+        }
+
+        execvp(argv[optind], &argv[optind]);
+        fprintf(stderr, "Could not run '%s': %s\n", argv[optind], strerror(errno));
+        _exit(127);
+    }
+
+#ifdef __linux__
+    counters[0] = open_counter(pid, PERF_COUNT_HW_CPU_CYCLES);
+    counters[1] = open_counter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+#endif
+
+    close(gate[0]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    close(gate[1]);
+
+    if (waitpid(pid, &status, 0) != pid)
+    {
+        fprintf(stderr, "Could not wait for '%s': %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Generated programs exit with the value of the current cell, so only a signal is a failure
+    if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "'%s' did not terminate normally\n", argv[optind]);
+        return 1;
+    }
+
+    printf("%lld", (long long) (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec));
+    print_counter(counters[0]);
+    print_counter(counters[1]);
+    printf("\n");
+
+    return 0;
+}
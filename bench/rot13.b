@@ -0,0 +1,32 @@
+rot13: filter that rotates letters by 13 places until end of input
+Letters are found with comparison loops so every byte costs a few hundred instructions
+
++[>[-],>+<[->>>+<+<<]>>>[-<<<+>>>]<[>+++++++++++++++++++++++++++++++++++++++++++
+++++++++++++++++++++++>+++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+++++++++++++++++++++++++++++++++++>[-]<<<<<[->>>>>>>>>>+<<+<<<<<<<<]>>>>>>>>>>[-
+<<<<<<<<<<+>>>>>>>>>>]<<<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[->+<<
+[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>->[-]]<[<<<<<[-]+>>>>>-]<]<[-]<<[-]<<<<<<[-
+>>>>>>>>>>+<<+<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<<[->>>>>>+<+<<<<<]
+>>>>>>[-<<<<<<+>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>->[-]]<[<<<<[-
+]+>>>>-]<]<[-]<<<<<[-]>[-]>>>>+<<<[->>>>>+<+<<<<]>>>>>[-<<<<<+>>>>>]<[<->[-]]<[<
+<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<+>>[-]]<-]<<<[-]>[-]>[-<<<<<<<----------------
+------------------------------------>>>>>>>>>>>++++++++++++++++++++++++++<<[-]>[
+-]>[->>+<+<]>>[-<<+>>]<<<<<<<<<<<<<[->>>>>>>>>>>>-<<+>>>+<[->>>+<+<<]>>>[-<<<+>>
+>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<[-]<+>>>>-]<<<<<<<<<<<<<]>>>>>>>>>>>>
+[-]<[-]<<[-]>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<<<<<<+++++++++++++++++++++++++++++++++
+++++++++++++++++++++++++++++++++>>>>>>>]<<<<++++++++++++++++++++++++++++++++++++
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++>++++++++++++++++++
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++++++++++++++++++++>[-]<<<<<[->>>>>>>>>>+<<+<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<
+<+>>>>>>>>>>]<<<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[->+<<[->>>>+<+
+<<<]>>>>[-<<<<+>>>>]<[<<<->>->[-]]<[<<<<<[-]+>>>>>-]<]<[-]<<[-]<<<<<<[->>>>>>>>>
+>+<<+<<<<<<<<]>>>>>>>>>>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<<[->>>>>>+<+<<<<<]>>>>>>[-<
+<<<<<+>>>>>>]<[->+<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<<<->>->[-]]<[<<<<[-]+>>>>-]<
+]<[-]<<<<<[-]>[-]>>>>+<<<[->>>>>+<+<<<<]>>>>>[-<<<<<+>>>>>]<[<->[-]]<[<<[->>>>+<
++<<<]>>>>[-<<<<+>>>>]<[<<+>>[-]]<-]<<<[-]>[-]>[-<<<<<<<-------------------------
+----------------------------------------------------------->>>>>>>>>>>++++++++++
+++++++++++++++++<<[-]>[-]>[->>+<+<]>>[-<<+>>]<<<<<<<<<<<<<[->>>>>>>>>>>>-<<+>>>+
+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<[->>>+<<+<]>>>[-<<<+>>>]<<<<[-]<+>>>>-]<<<
+<<<<<<<<<<]>>>>>>>>>>>>[-]<[-]<<[-]>[-<<<<<<<<<<+>>>>>>>>>>]<<<<<<<<<<++++++++++
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++++++++>>>>>>>]<<<<<<<.>->[-]]<[<<[-]>>-]<[-]<]
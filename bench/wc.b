@@ -0,0 +1,157 @@
+wc: counts lines and words and bytes of the input with eight digit decimal counters
+
++[>[-],>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[
+-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[<<<<<<<<<+[->>>
+>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<---------->+<[->>>+<
++<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<[-]>+[->>>>>>>>>>>>+<+<<<<<<<<<<<]>>>>>>>
+>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]
+<[<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>+<+<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>
+>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<[-]>+
+[->>>>>>>>>>>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>>]<
+---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>
+>>>>+<+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>]<--------
+-->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>+<
++<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<----------
+>+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>+<
++<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>]<------
+---->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<[-]>+>>>>>>>>>>>>>>>>
+-]<[-]<-]<[-]<-]<[-]<-]<[-]<-]<[-]<-]<[-]<-]<[-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]<
+<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<+<<<]>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]
+<<<<<<<<<<<<<<<<<<<<<<<<<<<--------->>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<
+<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]+>>>>>>>>>>>>>>>>>>>>>>>>>>>>-]<<
+<<<<<<<<<<<<<<<<<<<<<<<<<->>>>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<
+<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[<->
+[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]+>>+[->>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<
+<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<
++>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<
+<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[
+-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-
+<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------
+->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<<<<<[-]>+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>-]<[-]<-]<[-]<-]<[-]<-]
+<[-]<-]<[-]<-]<[-]<-]<[-]<-]<<<<<<<<<<<<<<<<<<<<<<<<<<<---------------------->>>
+>>>>>>>>>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>
+>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<
+<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<
+<<<<<[-]+>>>>>>>>>>>>>>>>>>>>>>>>>>>>-]<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>
+>>>>>>>>>>>>>>>>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>>>>>>>+<+
+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<
+<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>
+>>>>>>>>>>>>>>>>>>>>>>>>>>>>->[-]]<[>+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>
+>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>]<[<
+->[-]]<[<<<<<<<<<<<<<<<<<<<+[->>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<]>>>>>
+>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>
+>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>
+>+<+<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>
+>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<
+<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>
+>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<
+]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>+
+<+<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<+>>>
+>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<
+<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>
+>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<-----
+----->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>
+>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<
+<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>
+[-<<<+>>>]<[<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+[->>>>>>>>>>>>>>>>>>>>>>>>>>
+>+<+<<<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<
+<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>>>]<---------->+<[->>>+<+<<]>>>[-<<<+>>>]<[<->[
+-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>+>>>>>>>>>>>>>>>>>>>>>>>>>>-]<[-]<-]<[-]<-]<
+[-]<-]<[-]<-]<[-]<-]<[-]<-]<[-]<-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]+>>>>>>>>>>>>
+>>>>>>>>>>>>>>>>>-]<<->[-]]<[<<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]>>>>>>>>>>>>>>>>>>>
+>>>>>>>>>>-]<<<<<<<<<<<<<<<<<<<<<<<<<<<<[-]<]>>>>>>>>>>>>>>>>>>>>>>>>>>>>>[-]<<<
+<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>[-<<
+<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<
+<<<<<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++.---------------------
+--------------------------->>>>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>
+>>>>>>>>>>+<+<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<+>>>>
+>>>>>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<<<<++++++++++
+++++++++++++++++++++++++++++++++++++++.-----------------------------------------
+------->>>>>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>+<+<<<<
+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>
+>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<<<<<++++++++++++++++++++++
+++++++++++++++++++++++++++.------------------------------------------------>>>>>
+>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<
+<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>]<
+[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<<<<<<++++++++++++++++++++++++++
+++++++++++++++++++++++.------------------------------------------------>>>>>>>>>
+>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<
+<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>>>>>>>
+>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<<<<<<<++++++++++++++++++++++
+++++++++++++++++++++++++++.------------------------------------------------>>>>>
+>>>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>>>>>+<+<<<<<<<
+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>
+>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<<<<<<<<++++++++++
+++++++++++++++++++++++++++++++++++++++.-----------------------------------------
+------->>>>>>>>>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>>>>>
+>>>>>+<+<<<<<<<<<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<<<<
+<<<<<+>>>>>>>>>>>>>>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<
+<<<<<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++.---------------------
+--------------------------->>>>>>>>>>>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<<<<<<<<<<
+++++++++++++++++++++++++++++++++++++++++++++++++.-------------------------------
+----------------->>>>>>>>>>>>>>>>>>>>>>>>[-]++++++++++++++++++++++++++++++++.[-]
+<<<<<<<<<[->>>>>>>>>>>+<+<<<<<<<<<<]>>>>>>>>>>>[-<<<<<<<<<<<+>>>>>>>>>>>]<[<[-]+
+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<+++++++++++++++++++++++++++++++++++++++++++
++++++.------------------------------------------------>>>>>>>>>>[-]]<<<<<<<<<<<[
+->>>>>>>>>>>>+<+<<<<<<<<<<<]>>>>>>>>>>>>[-<<<<<<<<<<<<+>>>>>>>>>>>>]<[<[-]+>[-]]
+<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<+++++++++++++++++++++++++++++++++++++++++++++++
++.------------------------------------------------>>>>>>>>>>>[-]]<<<<<<<<<<<<[->
+>>>>>>>>>>>>+<+<<<<<<<<<<<<]>>>>>>>>>>>>>[-<<<<<<<<<<<<<+>>>>>>>>>>>>>]<[<[-]+>[
+-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<+++++++++++++++++++++++++++++++++++++++++++
++++++.------------------------------------------------>>>>>>>>>>>>[-]]<<<<<<<<<<
+<<<[->>>>>>>>>>>>>>+<+<<<<<<<<<<<<<]>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<+>>>>>>>>>>>>>
+>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<+++++++++++++++++++++++++++++++
++++++++++++++++++.------------------------------------------------>>>>>>>>>>>>>[
+-]]<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>[-<<<<<<<<<<<
+<<<<+>>>>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<+++++++++++
++++++++++++++++++++++++++++++++++++++.------------------------------------------
+------>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<[->>>>>>>>>>>>>>>>+<+<<<<<<<<<<<<<<<]>>>>
+>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]
+<[<<<<<<<<<<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++.--------------
+---------------------------------->>>>>>>>>>>>>>>[-]]<<<<<<<<<<<<<<<<[->>>>>>>>>
+>>>>>>>>+<+<<<<<<<<<<<<<<<<]>>>>>>>>>>>>>>>>>[-<<<<<<<<<<<<<<<<<+>>>>>>>>>>>>>>>
+>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<<<<<<<<<+++++++++++++++++++++++++++
++++++++++++++++++++++.------------------------------------------------>>>>>>>>>>
+>>>>>>[-]]<<<<<<<<<<<<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++.----
+-------------------------------------------->>>>>>>>>>>>>>>>[-]+++++++++++++++++
++++++++++++++++.[-]<[->>>+<+<<]>>>[-<<<+>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<
+++++++++++++++++++++++++++++++++++++++++++++++++.-------------------------------
+----------------->>[-]]<<<[->>>>+<+<<<]>>>>[-<<<<+>>>>]<[<[-]+>[-]]<[->>+<+<]>>[
+-<<+>>]<[<<<++++++++++++++++++++++++++++++++++++++++++++++++.-------------------
+----------------------------->>>[-]]<<<<[->>>>>+<+<<<<]>>>>>[-<<<<<+>>>>>]<[<[-]
++>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<++++++++++++++++++++++++++++++++++++++++++++++++
+.------------------------------------------------>>>>[-]]<<<<<[->>>>>>+<+<<<<<]>
+>>>>>[-<<<<<<+>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<++++++++++++++++++++
+++++++++++++++++++++++++++++.------------------------------------------------>>>
+>>[-]]<<<<<<[->>>>>>>+<+<<<<<<]>>>>>>>[-<<<<<<<+>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>
+[-<<+>>]<[<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++.---------------
+--------------------------------->>>>>>[-]]<<<<<<<[->>>>>>>>+<+<<<<<<<]>>>>>>>>[
+-<<<<<<<<+>>>>>>>>]<[<[-]+>[-]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<++++++++++++++++++++
+++++++++++++++++++++++++++++.------------------------------------------------>>>
+>>>>[-]]<<<<<<<<[->>>>>>>>>+<+<<<<<<<<]>>>>>>>>>[-<<<<<<<<<+>>>>>>>>>]<[<[-]+>[-
+]]<[->>+<+<]>>[-<<+>>]<[<<<<<<<<++++++++++++++++++++++++++++++++++++++++++++++++
+.------------------------------------------------>>>>>>>>[-]]<<<<<<<<<++++++++++
+++++++++++++++++++++++++++++++++++++++.-----------------------------------------
+------->>>>>>>>[-]++++++++++.[-]
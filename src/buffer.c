@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "buffer.h"
+
+
+int buffer_init(struct buffer* buffer, size_t capacity)
+{
+    buffer->size = 0;
+    buffer->capacity = capacity > 0 ? capacity : 1;
+    buffer->data = (unsigned char*) malloc(buffer->capacity);
+
+    if (buffer->data == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+
+int buffer_reserve(struct buffer* buffer, size_t length)
+{
+    if (buffer->capacity - buffer->size < length)
+    {
+        size_t capacity = buffer->capacity * 2;
+        while (capacity - buffer->size < length)
+        {
+            capacity *= 2;
+        }
+
+        unsigned char* data = (unsigned char*) realloc(buffer->data, capacity);
+        if (data == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return -ENOMEM;
+        }
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    return 0;
+}
+
+
+int buffer_append(struct buffer* buffer, const void* data, size_t length)
+{
+    int status = buffer_reserve(buffer, length);
+
+    if (status == 0)
+    {
+        memcpy(buffer->data + buffer->size, data, length);
+        buffer->size += length;
+    }
+
+    return status;
+}
+
+
+void buffer_free(struct buffer* buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef __BUFFER_H__
+#define __BUFFER_H__
+
+#include <stddef.h>
+
+
+/* Contiguous, growable buffer that the code is emitted into
+ *
+ * The whole program ends up in one piece of memory, so it can be written
+ * to file or copied into executable memory in one go.
+ */
+struct buffer
+{
+    unsigned char*  data;       // bytes emitted so far
+    size_t          size;       // number of bytes in use
+    size_t          capacity;   // number of bytes allocated
+};
+
+
+/* Allocate room for a buffer of the given initial capacity */
+int buffer_init(struct buffer* buffer, size_t capacity);
+
+
+/* Make sure there is room for at least length more bytes */
+int buffer_reserve(struct buffer* buffer, size_t length);
+
+
+/* Append bytes to the end of the buffer, growing it if necessary */
+int buffer_append(struct buffer* buffer, const void* data, size_t length);
+
+
+/* Release the memory held by the buffer */
+void buffer_free(struct buffer* buffer);
+
+#endif
@@ -1,319 +1,2739 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
 #include <sys/syscall.h>
-#include "token.h"
+#include <pthread.h>
+#include "ir.h"
+#include "target.h"
 #include "compiler.h"
+#include "profile.h"
 
 
-static struct page* alloc_page(struct page* prev, size_t page_size)
+/* Longest sequence of bytes a single instruction translates to */
+#define MAX_INSTR_SIZE  128
+
+
+/* Offsets of the runtime support routines from the beginning of the code */
+struct runtime
+{
+    uint32_t    flush;      // write the contents of the output buffer to stdout
+    uint32_t    putc;       // append %al to the output buffer, flush it if it is full
+    uint32_t    getc;       // next input byte in %rax, or the EOF value (-1 for no change)
+    uint32_t    scan_right; // move %rbx right to the nearest zero cell matching the stride pattern in %ecx
+    uint32_t    scan_left;  // move %rbx left to the nearest zero cell matching the stride pattern in %ecx
+};
+
+
+/* Buffer for assembling runtime code before it is added to the code */
+struct snippet
+{
+    size_t          size;
+    unsigned char   code[1024];
+};
+
+
+static void emit(struct snippet* snippet, size_t length, const char* code)
+{
+    memcpy(snippet->code + snippet->size, code, length);
+    snippet->size += length;
+}
+
+
+static void emit8(struct snippet* snippet, uint8_t value)
+{
+    snippet->code[snippet->size++] = value;
+}
+
+
+static void emit32(struct snippet* snippet, uint32_t value)
+{
+    memcpy(snippet->code + snippet->size, &value, sizeof(value));
+    snippet->size += sizeof(value);
+}
+
+
+static void emit64(struct snippet* snippet, uint64_t value)
+{
+    memcpy(snippet->code + snippet->size, &value, sizeof(value));
+    snippet->size += sizeof(value);
+}
+
+
+/* Emit a short forward branch and return where its displacement is */
+static size_t emit_branch(struct snippet* snippet, unsigned char opcode)
+{
+    snippet->code[snippet->size++] = opcode;
+    snippet->code[snippet->size++] = 0;
+    return snippet->size - 1;
+}
+
+
+/* Make a short forward branch land at the current position */
+static void set_branch(struct snippet* snippet, size_t displacement)
+{
+    snippet->code[displacement] = (unsigned char) (snippet->size - displacement - 1);
+}
+
+
+static void emit_syscall(struct snippet* snippet, uint32_t number, const struct target* target)
+{
+    /*
+     *  movq    <number>        ,   %rax
+     *  syscall
+     */
+    emit(snippet, 3, "\x48\xc7\xc0");
+    emit32(snippet, number);
+    emit(snippet, 2, "\x0f\x05");
+
+    if (target->carry_on_error)
+    {
+        /* Convert to the Linux convention of returning -errno
+         *
+         *  jnc     1f
+         *  negq    %rax
+         * 1:
+         */
+        emit(snippet, 5, "\x73\x03\x48\xf7\xd8");
+    }
+}
+
+
+static void emit_flush(struct snippet* snippet, const struct target* target)
+{
+    size_t empty;
+
+    /*
+     *  pushq   %rax
+     *  movl    OUTPUT_COUNT(%rbp)      ,   %edx    # how many bytes
+     *  testl   %edx                    ,   %edx
+     *  je      1f
+     *  movq    $1                      ,   %rdi    # file number 1 = stdout
+     *  leaq    OUTPUT_BUFFER(%rbp)     ,   %rsi
+     *  movq    <sys_write>             ,   %rax
+     *  syscall
+     *  movl    $0                      ,   OUTPUT_COUNT(%rbp)
+     * 1:
+     *  popq    %rax
+     *  retq
+     */
+    emit(snippet, 3, "\x50\x8b\x95");
+    emit32(snippet, OUTPUT_COUNT);
+    emit(snippet, 2, "\x85\xd2");
+    empty = emit_branch(snippet, 0x74);
+    emit(snippet, 10, "\x48\xc7\xc7\x01\x00\x00\x00\x48\x8d\xb5");
+    emit32(snippet, OUTPUT_BUFFER);
+    emit_syscall(snippet, target->sys_write, target);
+    emit(snippet, 2, "\xc7\x85");
+    emit32(snippet, OUTPUT_COUNT);
+    emit32(snippet, 0);
+    set_branch(snippet, empty);
+    emit(snippet, 2, "\x58\xc3");
+}
+
+
+static void emit_putc(struct snippet* snippet, size_t flush)
+{
+    /*
+     *  movl    OUTPUT_COUNT(%rbp)      ,   %ecx
+     *  movb    %al                     ,   OUTPUT_BUFFER(%rbp, %rcx)
+     *  incl    %ecx
+     *  movl    %ecx                    ,   OUTPUT_COUNT(%rbp)
+     *  cmpl    OUTPUT_SIZE             ,   %ecx
+     *  je      flush
+     *  retq
+     */
+    emit(snippet, 2, "\x8b\x8d");
+    emit32(snippet, OUTPUT_COUNT);
+    emit(snippet, 3, "\x88\x84\x0d");
+    emit32(snippet, OUTPUT_BUFFER);
+    emit(snippet, 4, "\xff\xc1\x89\x8d");
+    emit32(snippet, OUTPUT_COUNT);
+    emit(snippet, 2, "\x81\xf9");
+    emit32(snippet, OUTPUT_SIZE);
+    emit(snippet, 2, "\x0f\x84");
+    emit32(snippet, flush - (snippet->size + 4));
+    emit(snippet, 1, "\xc3");
+}
+
+
+static void emit_getc(struct snippet* snippet, const struct target* target, enum eof_behaviour eof)
+{
+    size_t available;
+    size_t end_of_file;
+    int32_t eof_value = eof == EOF_ZERO ? 0 : -1;
+
+    /*
+     *  movq    INPUT_POS(%rbp)         ,   %rsi
+     *  cmpq    INPUT_END(%rbp)         ,   %rsi
+     *  jb      2f
+     *  xorl    %edi                    ,   %edi    # file number 0 = stdin
+     *  leaq    INPUT_BUFFER(%rbp)      ,   %rsi
+     *  movl    INPUT_SIZE              ,   %edx
+     *  movq    <sys_read>              ,   %rax
+     *  syscall
+     *  testq   %rax                    ,   %rax
+     *  jle     3f                              # end of file or error
+     *  leaq    INPUT_BUFFER(%rbp)      ,   %rsi
+     *  addq    %rsi                    ,   %rax
+     *  movq    %rax                    ,   INPUT_END(%rbp)
+     * 2:
+     *  movzbl  (%rsi)                  ,   %eax
+     *  incq    %rsi
+     *  movq    %rsi                    ,   INPUT_POS(%rbp)
+     *  retq
+     * 3:
+     *  movq    <EOF value>             ,   %rax    # sign-extended to any cell width
+     *  retq
+     */
+    emit(snippet, 3, "\x48\x8b\xb5");
+    emit32(snippet, INPUT_POS);
+    emit(snippet, 3, "\x48\x3b\xb5");
+    emit32(snippet, INPUT_END);
+    available = emit_branch(snippet, 0x72);
+    emit(snippet, 5, "\x31\xff\x48\x8d\xb5");
+    emit32(snippet, INPUT_BUFFER);
+    emit(snippet, 1, "\xba");
+    emit32(snippet, INPUT_SIZE);
+    emit_syscall(snippet, target->sys_read, target);
+    emit(snippet, 3, "\x48\x85\xc0");
+    end_of_file = emit_branch(snippet, 0x7e);
+    emit(snippet, 3, "\x48\x8d\xb5");
+    emit32(snippet, INPUT_BUFFER);
+    emit(snippet, 6, "\x48\x01\xf0\x48\x89\x85");
+    emit32(snippet, INPUT_END);
+    set_branch(snippet, available);
+    emit(snippet, 9, "\x0f\xb6\x06\x48\xff\xc6\x48\x89\xb5");
+    emit32(snippet, INPUT_POS);
+    emit(snippet, 1, "\xc3");
+    set_branch(snippet, end_of_file);
+    emit(snippet, 3, "\x48\xc7\xc0");
+    emit32(snippet, eof_value);
+    emit(snippet, 1, "\xc3");
+}
+
+
+/* Emit a short backward branch to target */
+static void emit_branch_back(struct snippet* snippet, unsigned char opcode, size_t target)
+{
+    snippet->code[snippet->size] = opcode;
+    snippet->code[snippet->size + 1] = (unsigned char) (target - (snippet->size + 2));
+    snippet->size += 2;
+}
+
+
+/* Search the tape for a zero cell, one vector of width bytes at a time */
+static void emit_scan_loop(struct snippet* snippet, int forward, uint8_t width, int cell_bits)
+{
+    size_t loop;
+    size_t found;
+    char compare = cell_bits == 8 ? 0x74 : cell_bits == 16 ? 0x75 : 0x76;
+
+    /* Vectors are loaded from aligned addresses, so they never straddle a page.
+     * Cells before the start position (after it, when scanning backwards) and 
+     * cells that are not a multiple of the stride away from it are masked out
+     * of the comparison result.
+     *
+     *  andl    <width - 1>             ,   %ecx    # position within vector
+     *  rol     %cl                     ,   %esi    # stride pattern for this position
+     *  movl    $-1                     ,   %edi
+     *  shll    %cl                     ,   %edi    # only cells from the start position
+     *  andl    %esi                    ,   %edi
+     *  movq    %rbx                    ,   %rax
+     *  andq    <-width>                ,   %rax    # aligned vector holding the start position
+     *  pxor    %xmm0                   ,   %xmm0
+     * 1:
+     *  movdqa  (%rax)                  ,   %xmm1
+     *  pcmpeqb %xmm0                   ,   %xmm1   # pcmpeqw or pcmpeqd for wider cells
+     *  pmovmskb %xmm1                  ,   %ecx    # all bytes of a zero cell are set
+     *  andl    %edi                    ,   %ecx
+     *  jnz     2f
+     *  movl    %esi                    ,   %edi    # all cells of the stride from now on
+     *  addq    <width>                 ,   %rax
+     *  jmp     1b
+     * 2:
+     *  bsfl    %ecx                    ,   %ecx
+     *  addq    %rcx                    ,   %rax
+     *  movq    %rax                    ,   %rbx
+     *  retq
+     *
+     * The backward scan masks with 0xffff >> (15 - position) instead, goes down 
+     * instead of up and looks for the highest set bit with bsrl. The 32 byte wide
+     * version uses AVX2 instead of SSE2, and ends with vzeroupper. The stride 
+     * pattern only has bits for the first byte of each cell, so both find where
+     * the zero cell starts.
+     */
+    emit(snippet, 2, "\x83\xe1");
+    emit8(snippet, width - 1);
+
+    if (width == 16)
+    {
+        emit(snippet, 3, "\x66\xd3\xc6");
+    }
+    else
+    {
+        emit(snippet, 2, "\xd3\xc6");
+    }
+
+    if (forward)
+    {
+        emit(snippet, 7, "\xbf\xff\xff\xff\xff\xd3\xe7");
+    }
+    else
+    {
+        emit(snippet, 1, "\xbf");
+        emit32(snippet, width == 16 ? 0xffff : 0xffffffff);
+        emit(snippet, 2, "\x83\xf1");
+        emit8(snippet, width - 1);
+        emit(snippet, 2, "\xd3\xef");
+    }
+
+    emit(snippet, 8, "\x21\xf7\x48\x89\xd8\x48\x83\xe0");
+    emit8(snippet, -width);
+
+    if (width == 16)
+    {
+        emit(snippet, 4, "\x66\x0f\xef\xc0");
+        loop = snippet->size;
+        emit(snippet, 6, "\x66\x0f\x6f\x08\x66\x0f");
+        emit8(snippet, compare);
+        emit(snippet, 5, "\xc8\x66\x0f\xd7\xc9");
+    }
+    else
+    {
+        emit(snippet, 4, "\xc5\xfd\xef\xc0");
+        loop = snippet->size;
+        emit(snippet, 2, "\xc5\xfd");
+        emit8(snippet, compare);
+        emit(snippet, 5, "\x08\xc5\xfd\xd7\xc9");
+    }
+
+    emit(snippet, 2, "\x21\xf9");
+    found = emit_branch(snippet, 0x75);
+    emit(snippet, 5, forward ? "\x89\xf7\x48\x83\xc0" : "\x89\xf7\x48\x83\xe8");
+    emit8(snippet, width);
+    emit_branch_back(snippet, 0xeb, loop);
+
+    set_branch(snippet, found);
+    emit(snippet, 3, forward ? "\x0f\xbc\xc9" : "\x0f\xbd\xc9");
+    emit(snippet, 6, "\x48\x01\xc8\x48\x89\xc3");
+
+    if (width == 32)
+    {
+        emit(snippet, 3, "\xc5\xf8\x77");
+    }
+
+    emit(snippet, 1, "\xc3");
+}
+
+
+static void emit_scan(struct snippet* snippet, int forward, int avx2, int cell_bits)
+{
+    size_t wide;
+
+    /* Move the cell pointer to the nearest zero cell a multiple of the stride away
+     *
+     *  movl    %ecx                    ,   %esi    # bit pattern of the stride
+     *  movl    %ebx                    ,   %ecx
+     *  cmpb    $0                      ,   SCAN_AVX2(%rbp)
+     *  jne     <32 byte version>
+     */
+    emit(snippet, 4, "\x89\xce\x89\xd9");
+
+    if (avx2)
+    {
+        emit(snippet, 2, "\x80\xbd");
+        emit32(snippet, SCAN_AVX2);
+        emit(snippet, 1, "\x00");
+        wide = emit_branch(snippet, 0x75);
+        emit_scan_loop(snippet, forward, 16, cell_bits);
+        set_branch(snippet, wide);
+        emit_scan_loop(snippet, forward, 32, cell_bits);
+        return;
+    }
+
+    emit_scan_loop(snippet, forward, 16, cell_bits);
+}
+
+
+/* Find out at start-up if the CPU and the operating system support AVX2 */
+static int add_cpu_detection(struct buffer* code)
+{
+    struct snippet snippet;
+    size_t unsupported;
+    size_t disabled;
+    snippet.size = 0;
+
+    /* This runs before the cell pointer is set up, so %rbx is free
+     *
+     *  movl    $1                  ,   %eax
+     *  cpuid
+     *  andl    $0x18000000         ,   %ecx    # OSXSAVE and AVX
+     *  cmpl    $0x18000000         ,   %ecx
+     *  jne     1f
+     *  xorl    %ecx                ,   %ecx
+     *  xgetbv
+     *  andl    $6                  ,   %eax    # XMM and YMM state enabled by the OS
+     *  cmpl    $6                  ,   %eax
+     *  jne     1f
+     *  movl    $7                  ,   %eax
+     *  xorl    %ecx                ,   %ecx
+     *  cpuid
+     *  shrl    $5                  ,   %ebx    # AVX2
+     *  andl    $1                  ,   %ebx
+     *  movb    %bl                 ,   SCAN_AVX2(%rbp)
+     * 1:
+     */
+    emit(&snippet, 19, "\xb8\x01\x00\x00\x00\x0f\xa2\x81\xe1\x00\x00\x00\x18\x81\xf9\x00\x00\x00\x18");
+    unsupported = emit_branch(&snippet, 0x75);
+    emit(&snippet, 11, "\x31\xc9\x0f\x01\xd0\x83\xe0\x06\x83\xf8\x06");
+    disabled = emit_branch(&snippet, 0x75);
+    emit(&snippet, 17, "\xb8\x07\x00\x00\x00\x31\xc9\x0f\xa2\xc1\xeb\x05\x83\xe3\x01\x88\x9d");
+    emit32(&snippet, SCAN_AVX2);
+    set_branch(&snippet, unsupported);
+    set_branch(&snippet, disabled);
+
+    return buffer_append(code, snippet.code, snippet.size);
+}
+
+
+static int add_runtime(struct buffer* code, struct runtime* runtime, const struct target* target, const struct options* options, int scans)
+{
+    struct snippet snippet;
+    snippet.size = 0;
+
+    /* Routines are placed right after the prologue, so calls to them are always backwards
+     *
+     *  jmp     <past routines>
+     */
+    emit(&snippet, 1, "\xe9");
+    emit32(&snippet, 0);
+
+    if (options->buffered_output)
+    {
+        runtime->flush = code->size + snippet.size;
+        emit_flush(&snippet, target);
+
+        runtime->putc = code->size + snippet.size;
+        emit_putc(&snippet, runtime->flush - code->size);
+    }
+
+    if (options->buffered_input)
+    {
+        runtime->getc = code->size + snippet.size;
+        emit_getc(&snippet, target, options->eof);
+    }
+
+    if (scans)
+    {
+        runtime->scan_right = code->size + snippet.size;
+        emit_scan(&snippet, 1, options->avx2, options->cell_bits);
+
+        runtime->scan_left = code->size + snippet.size;
+        emit_scan(&snippet, 0, options->avx2, options->cell_bits);
+    }
+
+    *((uint32_t*) (snippet.code + 1)) = snippet.size - 5;
+    return buffer_append(code, snippet.code, snippet.size);
+}
+
+
+/* Map the tape over the gap left for it between the guard regions
+ *
+ * The mapping does not count against the memory limits, pages are only
+ * committed when they are first touched. It can still fail, for example
+ * under strict overcommit or an address space limit, and then the program
+ * says so on stderr and exits with status 1 before it runs.
+ */
+static int add_tape_mapping(struct buffer* code, const struct target* target, uint64_t tape_addr, uint64_t tape_size)
+{
+    static const char message[24] = "Could not map the tape\n";
+    struct snippet snippet;
+    size_t mapped;
+    snippet.size = 0;
+
+    /*
+     *  movq    <tape address>          ,   %rdi
+     *  movq    <tape size>             ,   %rsi
+     *  movl    $3                      ,   %edx    # PROT_READ | PROT_WRITE
+     *  movl    <flags>                 ,   %r10d   # MAP_PRIVATE | MAP_FIXED | anonymous, not reserved
+     *  movq    $-1                     ,   %r8     # no file
+     *  xorl    %r9d                    ,   %r9d    # offset 0
+     *  movq    <sys_mmap>              ,   %rax
+     *  syscall
+     */
+    emit(&snippet, 2, "\x48\xbf");
+    emit64(&snippet, tape_addr);
+    emit(&snippet, 2, "\x48\xbe");
+    emit64(&snippet, tape_size);
+    emit(&snippet, 7, "\xba\x03\x00\x00\x00\x41\xba");
+    emit32(&snippet, 0x12 | target->map_anonymous);
+    emit(&snippet, 10, "\x49\xc7\xc0\xff\xff\xff\xff\x45\x31\xc9");
+    emit_syscall(&snippet, target->sys_mmap, target);
+
+    /*
+     *  testq   %rax                    ,   %rax
+     *  jns     1f
+     */
+    emit(&snippet, 3, "\x48\x85\xc0");
+    mapped = emit_branch(&snippet, 0x79);
+
+    /* The message is built on the stack, so there is no data in the code
+     *
+     *  movq    <message bytes 16-23>   ,   %rax
+     *  pushq   %rax
+     *  movq    <message bytes 8-15>    ,   %rax
+     *  pushq   %rax
+     *  movq    <message bytes 0-7>     ,   %rax
+     *  pushq   %rax
+     */
+    for (size_t part = sizeof(message) / 8; part-- > 0; )
+    {
+        emit(&snippet, 2, "\x48\xb8");
+        emit(&snippet, 8, message + 8 * part);
+        emit8(&snippet, 0x50);
+    }
+
+    /*
+     *  movl    $2                      ,   %edi    # stderr
+     *  movq    %rsp                    ,   %rsi
+     *  movl    <message length>        ,   %edx
+     *  movq    <sys_write>             ,   %rax
+     *  syscall
+     *  movl    $1                      ,   %edi
+     *  movq    <sys_exit>              ,   %rax
+     *  syscall
+     * 1:
+     */
+    emit(&snippet, 8, "\xbf\x02\x00\x00\x00\x48\x89\xe6");
+    emit8(&snippet, 0xba);
+    emit32(&snippet, sizeof(message) - 1);
+    emit_syscall(&snippet, target->sys_write, target);
+    emit(&snippet, 5, "\xbf\x01\x00\x00\x00");
+    emit_syscall(&snippet, target->sys_exit, target);
+    set_branch(&snippet, mapped);
+
+    return buffer_append(code, snippet.code, snippet.size);
+}
+
+
+/* Map stdin directly if it is a regular file, so that getc reads straight from the mapping */
+static int add_input_mapping(struct buffer* code, const struct target* target)
+{
+    struct snippet snippet;
+    size_t error;
+    size_t empty;
+    size_t failed;
+    size_t done;
+    snippet.size = 0;
+
+    /*
+     *  xorl    %edi                    ,   %edi    # file number 0 = stdin
+     *  xorl    %esi                    ,   %esi
+     *  movl    $1                      ,   %edx    # SEEK_CUR
+     *  movq    <sys_lseek>             ,   %rax
+     *  syscall
+     *  testq   %rax                    ,   %rax
+     *  js      1f                                  # not seekable
+     *  movq    %rax                    ,   INPUT_POS(%rbp)
+     */
+    emit(&snippet, 9, "\x31\xff\x31\xf6\xba\x01\x00\x00\x00");
+    emit_syscall(&snippet, target->sys_lseek, target);
+    emit(&snippet, 3, "\x48\x85\xc0");
+    error = emit_branch(&snippet, 0x78);
+    emit(&snippet, 3, "\x48\x89\x85");
+    emit32(&snippet, INPUT_POS);
+
+    /*
+     *  xorl    %edi                    ,   %edi
+     *  xorl    %esi                    ,   %esi
+     *  movl    $2                      ,   %edx    # SEEK_END
+     *  movq    <sys_lseek>             ,   %rax
+     *  syscall
+     *  testq   %rax                    ,   %rax
+     *  jle     1f                                  # empty or failed
+     *  movq    %rax                    ,   INPUT_END(%rbp)
+     */
+    emit(&snippet, 9, "\x31\xff\x31\xf6\xba\x02\x00\x00\x00");
+    emit_syscall(&snippet, target->sys_lseek, target);
+    emit(&snippet, 3, "\x48\x85\xc0");
+    empty = emit_branch(&snippet, 0x7e);
+    emit(&snippet, 3, "\x48\x89\x85");
+    emit32(&snippet, INPUT_END);
+
+    /*
+     *  movq    %rax                    ,   %rsi    # length = size of file
+     *  xorl    %edi                    ,   %edi    # let the kernel choose the address
+     *  movl    $1                      ,   %edx    # PROT_READ
+     *  movl    $2                      ,   %r10d   # MAP_PRIVATE
+     *  xorl    %r8d                    ,   %r8d    # file number 0 = stdin
+     *  xorl    %r9d                    ,   %r9d    # offset 0
+     *  movq    <sys_mmap>              ,   %rax
+     *  syscall
+     *  testq   %rax                    ,   %rax
+     *  js      1f
+     *  addq    %rax                    ,   INPUT_POS(%rbp)
+     *  addq    %rax                    ,   INPUT_END(%rbp)
+     *  jmp     2f
+     */
+    emit(&snippet, 22, "\x48\x89\xc6\x31\xff\xba\x01\x00\x00\x00\x41\xba\x02\x00\x00\x00\x45\x31\xc0\x45\x31\xc9");
+    emit_syscall(&snippet, target->sys_mmap, target);
+    emit(&snippet, 3, "\x48\x85\xc0");
+    failed = emit_branch(&snippet, 0x78);
+    emit(&snippet, 3, "\x48\x01\x85");
+    emit32(&snippet, INPUT_POS);
+    emit(&snippet, 3, "\x48\x01\x85");
+    emit32(&snippet, INPUT_END);
+    done = emit_branch(&snippet, 0xeb);
+
+    /* Could not map it, so fall back to reading from where the file was
+     * (which fails harmlessly if stdin is not seekable at all)
+     *
+     * 1:
+     *  xorl    %edi                    ,   %edi
+     *  movq    INPUT_POS(%rbp)         ,   %rsi
+     *  xorl    %edx                    ,   %edx    # SEEK_SET
+     *  movq    <sys_lseek>             ,   %rax
+     *  syscall
+     *  movq    $0                      ,   INPUT_POS(%rbp)
+     *  movq    $0                      ,   INPUT_END(%rbp)
+     * 2:
+     */
+    set_branch(&snippet, error);
+    set_branch(&snippet, empty);
+    set_branch(&snippet, failed);
+    emit(&snippet, 5, "\x31\xff\x48\x8b\xb5");
+    emit32(&snippet, INPUT_POS);
+    emit(&snippet, 2, "\x31\xd2");
+    emit_syscall(&snippet, target->sys_lseek, target);
+    emit(&snippet, 3, "\x48\xc7\x85");
+    emit32(&snippet, INPUT_POS);
+    emit32(&snippet, 0);
+    emit(&snippet, 3, "\x48\xc7\x85");
+    emit32(&snippet, INPUT_END);
+    emit32(&snippet, 0);
+    set_branch(&snippet, done);
+
+    return buffer_append(code, snippet.code, snippet.size);
+}
+
+
+/* Offset of the profile record of the given loop from the data base */
+static uint32_t loop_record(uint32_t loop)
+{
+    return PROFILE + sizeof(struct profile_header) + loop * sizeof(struct loop_profile);
+}
+
+
+/* Write the profile of an instrumented program to its file as the program exits
+ *
+ * The counters were counted in place, so only the header, the position of
+ * every loop and the path of the file are filled in here. If the file can
+ * not be opened, the profile is lost but the program still exits normally.
+ */
+static int add_profile_writer(struct buffer* code, const struct target* target, const struct program* program, const char* path, uint64_t loops)
+{
+    struct snippet snippet;
+    size_t failed;
+    size_t length = strlen(path) + 1;
+    uint32_t loop = 0;
+    uint64_t magic = PROFILE_MAGIC;
+    int status;
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        if (program->instrs[index].opcode != OP_LOOP_BEGIN)
+        {
+            continue;
+        }
+
+        /*
+         *  movl    <position>              ,   <position field>(%rbp)
+         */
+        snippet.size = 0;
+        emit(&snippet, 2, "\xc7\x85");
+        emit32(&snippet, loop_record(loop++) + offsetof(struct loop_profile, position));
+        emit32(&snippet, program->instrs[index].position);
+
+        if ((status = buffer_append(code, snippet.code, snippet.size)) < 0)
+        {
+            return status;
+        }
+    }
+
+    /*
+     *  movabsq <magic>                 ,   %rax
+     *  movq    %rax                    ,   PROFILE(%rbp)
+     *  movq    <loops>                 ,   PROFILE + 8(%rbp)
+     */
+    snippet.size = 0;
+    emit(&snippet, 2, "\x48\xb8");
+    emit64(&snippet, magic);
+    emit(&snippet, 3, "\x48\x89\x85");
+    emit32(&snippet, PROFILE + offsetof(struct profile_header, magic));
+    emit(&snippet, 3, "\x48\xc7\x85");
+    emit32(&snippet, PROFILE + offsetof(struct profile_header, count));
+    emit32(&snippet, (uint32_t) loops);
+
+    /* The path is stored eight bytes at a time, including its terminating 0
+     *
+     *  movabsq <eight bytes of path>   ,   %rax
+     *  movq    %rax                    ,   PROFILE_PATH + <n>(%rbp)
+     *  ...
+     */
+    for (size_t chunk = 0; chunk < length; chunk += 8)
+    {
+        uint64_t bytes = 0;
+        memcpy(&bytes, path + chunk, length - chunk < 8 ? length - chunk : 8);
+
+        emit(&snippet, 2, "\x48\xb8");
+        emit64(&snippet, bytes);
+        emit(&snippet, 3, "\x48\x89\x85");
+        emit32(&snippet, PROFILE_PATH + chunk);
+
+        if ((status = buffer_append(code, snippet.code, snippet.size)) < 0)
+        {
+            return status;
+        }
+        snippet.size = 0;
+    }
+
+    /*
+     *  leaq    PROFILE_PATH(%rbp)      ,   %rdi
+     *  movl    <flags>                 ,   %esi    # write only, create or truncate
+     *  movl    $0644                   ,   %edx
+     *  movq    <sys_open>              ,   %rax
+     *  syscall
+     *  testq   %rax                    ,   %rax
+     *  js      1f
+     *  movq    %rax                    ,   %rdi    # system calls leave %rdi alone
+     *  leaq    PROFILE(%rbp)           ,   %rsi
+     *  movl    <size of profile>       ,   %edx
+     *  movq    <sys_write>             ,   %rax
+     *  syscall
+     *  movq    <sys_close>             ,   %rax
+     *  syscall
+     * 1:
+     */
+    emit(&snippet, 3, "\x48\x8d\xbd");
+    emit32(&snippet, PROFILE_PATH);
+    emit(&snippet, 1, "\xbe");
+    emit32(&snippet, target->open_create);
+    emit(&snippet, 1, "\xba");
+    emit32(&snippet, 0644);
+    emit_syscall(&snippet, target->sys_open, target);
+    emit(&snippet, 3, "\x48\x85\xc0");
+    failed = emit_branch(&snippet, 0x78);
+    emit(&snippet, 6, "\x48\x89\xc7\x48\x8d\xb5");
+    emit32(&snippet, PROFILE);
+    emit(&snippet, 1, "\xba");
+    emit32(&snippet, loop_record(loops) - PROFILE);
+    emit_syscall(&snippet, target->sys_write, target);
+    emit_syscall(&snippet, target->sys_close, target);
+    set_branch(&snippet, failed);
+
+    return buffer_append(code, snippet.code, snippet.size);
+}
+
+
+/* Number of cells a loop can keep in registers, %r8b to %r11b */
+#define CACHE_REGISTERS 4
+
+
+/* Largest number of different cells counted when choosing which ones to keep in registers */
+#define MAX_CANDIDATES  32
+
+
+/* Cells kept in registers while the loop being emitted runs
+ *
+ * Cell offsets[i] lives in %r(8+i)b (or the wider register matching the
+ * cell width) from the loop begin until the loop exits, and is written back
+ * after the loop if dirty[i] is set. The loop cell is always in %r8b.
+ */
+struct cell_cache
+{
+    size_t      count;
+    int32_t     offsets[CACHE_REGISTERS];
+    int         dirty[CACHE_REGISTERS];
+};
+
+
+/* Branch forms of a loop, relaxed from the short ones until all branches reach */
+#define FAR_GUARD       0x01    // the loop begin jumps past the loop with je rel32 instead of rel8
+#define FAR_BACK        0x02    // the loop end branches back with rel32 instead of rel8
+
+
+/* Most additions in a row that are gathered into vector adds at once, longer runs are split */
+#define MAX_VECTOR_RUN      64
+
+
+/* Fewest cells a vector add has to change to beat adding to them one at a time
+ *
+ * In a loop, each iteration loads the cells the last one stored, so a vector
+ * add is as slow as forwarding a vector store to a load. Adding to cells one
+ * at a time is as fast up to about 6 cells, on the machines it was measured on.
+ */
+#define MIN_VECTOR_CELLS    8
+
+
+/* Displacement of a load from the constant pool, patched when the pool is placed */
+struct fixup
+{
+    uint32_t    field;      // address of the 32-bit displacement
+    uint32_t    constant;   // number of the constant it loads
+};
+
+
+/* Constants the vector adds load, placed after the code
+ *
+ * Every constant takes 16 bytes. Equal constants are only stored once; they
+ * are found through a hash table of constant numbers plus one, in which 0
+ * marks a free slot.
+ */
+struct constant_pool
+{
+    struct buffer   data;       // the constants, back to back
+    struct buffer   fixups;     // struct fixup for every load of a constant
+    uint32_t*       slots;
+    size_t          capacity;   // number of slots, a power of two
+};
+
+
+/* Additions in a row that the code is being emitted for
+ *
+ * Additions that are covered are done by the vector adds emitted before the
+ * first of them, and get no code of their own.
+ */
+struct vector_run
+{
+    size_t      start;                      // index of the first addition
+    size_t      length;                     // number of additions
+    uint8_t     covered[MAX_VECTOR_RUN];    // the addition is part of a vector add
+};
+
+
+/* Fewest instructions in a chunk of the program whose code is generated on its own
+ *
+ * Chunks only end before a loop at the top level, so no branch leaves a chunk.
+ * Their size does not depend on the number of threads, which keeps the code
+ * the same however many threads generate it.
+ */
+#define CHUNK_SIZE      65536
+
+
+/* Part of the program whose code is generated on its own, possibly on another thread
+ *
+ * The code is emitted as if it started at address 0. When the chunks are put
+ * together, the calls into the runtime and the loads of constants are fixed
+ * up. Chunks after the first start at a multiple of the loop alignment, so
+ * hot loops end up aligned wherever the chunk is placed.
+ */
+struct chunk
+{
+    size_t                  first;      // index of the first instruction
+    size_t                  last;       // index past the last instruction
+    uint32_t                loop;       // number of the first loop that starts in the chunk
+    uint32_t                base;       // address the code will start at, as far as the loop alignment can tell
+    struct buffer           code;
+    struct buffer           calls;      // addresses of the displacements of calls into the runtime
+    struct constant_pool    constants;
+    int                     status;
+};
+
+
+/* State shared by the code generation functions */
+struct codegen
+{
+    const struct program*   program;
+    const struct target*    target;
+    const struct options*   options;
+    struct runtime          runtime;
+    struct cell_cache       cache;
+    struct vector_run       run;
+    struct chunk*           chunk;      // chunk being emitted
+    uint32_t                loop;       // number of the loop being emitted, for its profile counters
+    uint8_t*                far;        // branch forms of every loop, by number
+};
+
+
+/* Loop whose end has not been emitted yet */
+struct open_loop
+{
+    uint32_t    test;       // address of the test of the loop cell at the top
+    uint32_t    guard;      // address right after the branch past the loop
+    uint32_t    body;       // address the body starts at
+    uint32_t    number;     // number of the loop
+};
+
+
+/* Register the cell at offset is kept in, or -1 if it is in memory */
+static int cached_register(const struct codegen* cg, int32_t offset)
+{
+    for (size_t index = 0; index < cg->cache.count; ++index)
+    {
+        if (cg->cache.offsets[index] == offset)
+        {
+            return (int) index;
+        }
+    }
+
+    return -1;
+}
+
+
+/* Choose the cells to keep in registers for the loop starting at index
+ *
+ * Only loops whose body is straight-line arithmetic qualify. They contain no
+ * calls or system calls that could clobber the registers, and as the 
+ * optimiser has folded away all pointer moves, the body addresses the same
+ * cells on every iteration. The loop cell and the most used other cells get
+ * a register.
+ */
+static void allocate_registers(const struct program* program, size_t index, struct cell_cache* cache)
+{
+    int32_t offsets[MAX_CANDIDATES];
+    size_t uses[MAX_CANDIDATES];
+    int dirty[MAX_CANDIDATES];
+    size_t candidates = 1;
+
+    cache->count = 0;
+
+    offsets[0] = 0;
+    uses[0] = SIZE_MAX;
+    dirty[0] = 0;
+
+    for (size_t body = index + 1; body < program->instrs[index].match; ++body)
+    {
+        const struct instr* instr = &program->instrs[body];
+        int32_t cells[2] = { instr->offset, instr->source };
+        size_t count = 1;
+
+        switch (instr->opcode)
+        {
+            case OP_MUL:
+                count = 2;
+                break;
+
+            case OP_ADD:
+            case OP_SET:
+                break;
+
+            default:
+                return;
+        }
+
+        for (size_t cell = 0; cell < count; ++cell)
+        {
+            size_t candidate;
+            for (candidate = 0; candidate < candidates && offsets[candidate] != cells[cell]; ++candidate);
+
+            if (candidate == candidates)
+            {
+                if (candidates == MAX_CANDIDATES)
+                {
+                    continue;
+                }
+
+                offsets[candidate] = cells[cell];
+                uses[candidate] = 0;
+                dirty[candidate] = 0;
+                ++candidates;
+            }
+
+            uses[candidate] += uses[candidate] != SIZE_MAX;
+            dirty[candidate] |= cell == 0;
+        }
+    }
+
+    // Pick the most used cells, the loop cell always comes first
+    while (cache->count < CACHE_REGISTERS && cache->count < candidates)
+    {
+        size_t best = 0;
+        for (size_t candidate = 1; candidate < candidates; ++candidate)
+        {
+            if (uses[candidate] > uses[best])
+            {
+                best = candidate;
+            }
+        }
+
+        if (uses[best] == 0)
+        {
+            break;
+        }
+
+        cache->offsets[cache->count] = offsets[best];
+        cache->dirty[cache->count] = dirty[best];
+        ++cache->count;
+        uses[best] = 0;
+    }
+}
+
+
+/* Does the profile show that the loop starting at instr seldom runs its body
+ *
+ * When most entries skip the body, loading cells into registers and writing
+ * them back costs more than the few iterations gain from having them there.
+ * Loops that never ran count as well, leaving them out makes the code smaller.
+ */
+static int rarely_iterates(const struct codegen* cg, const struct instr* instr)
+{
+    const struct loop_profile* counters;
+
+    if (cg->options->profile == NULL || (counters = profile_find(cg->options->profile, instr->position)) == NULL)
+    {
+        return 0;
+    }
+
+    // Caching paid off on the benchmarks down to about one iteration for every four entries
+    return counters->entries == 0 || counters->iterations < counters->entries / 4;
+}
+
+
+/* Should the body of the loop starting at index be aligned
+ *
+ * Without a profile, innermost loops are taken to be the hot ones. With a
+ * profile, loops that ran at least 1% of the iterations of the busiest loop
+ * are, nested or not.
+ */
+static int is_hot(const struct codegen* cg, size_t index)
+{
+    const struct instr* instr = &cg->program->instrs[index];
+    const struct loop_profile* counters;
+
+    if (cg->options->profile != NULL && (counters = profile_find(cg->options->profile, instr->position)) != NULL)
+    {
+        return counters->iterations > 0 && counters->iterations >= cg->options->profile->busiest / 100;
+    }
+
+    for (size_t body = index + 1; body < instr->match; ++body)
+    {
+        if (cg->program->instrs[body].opcode == OP_LOOP_BEGIN)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+/* Encode length bytes of padding with as few NOPs as possible, returns length */
+static size_t encode_nops(char* code, size_t length)
+{
+    static const char* const nops[] =
+    {
+        "",
+        "\x90",                                     // nop
+        "\x66\x90",                                 // xchgw   %ax, %ax
+        "\x0f\x1f\x00",                             // nopl    (%rax)
+        "\x0f\x1f\x40\x00",                         // nopl    0(%rax)
+        "\x0f\x1f\x44\x00\x00",                     // nopl    0(%rax, %rax, 1)
+        "\x66\x0f\x1f\x44\x00\x00",                 // nopw    0(%rax, %rax, 1)
+        "\x0f\x1f\x80\x00\x00\x00\x00",             // nopl    0(%rax)
+        "\x0f\x1f\x84\x00\x00\x00\x00\x00",         // nopl    0(%rax, %rax, 1)
+        "\x66\x0f\x1f\x84\x00\x00\x00\x00\x00"      // nopw    0(%rax, %rax, 1)
+    };
+    size_t done = 0;
+
+    while (done < length)
+    {
+        size_t size = length - done < 9 ? length - done : 9;
+        memcpy(code + done, nops[size], size);
+        done += size;
+    }
+
+    return length;
+}
+
+
+static size_t encode_call(char* code, uint32_t addr, uint32_t routine)
+{
+    /*
+     *  call    <routine>
+     */
+    code[0] = (char) 0xe8;
+    *((uint32_t*) (code + 1)) = routine - (addr + 5);
+
+    return 5;
+}
+
+
+/* Encode a call into the runtime from the code of the chunk being emitted
+ *
+ * addr is relative to the chunk, so the displacement is remembered to be
+ * fixed up when the chunk has its place. emit_program() makes room for
+ * the two calls an instruction can make at most.
+ */
+static size_t encode_routine_call(const struct codegen* cg, char* code, uint32_t addr, uint32_t routine)
+{
+    uint32_t field = addr + 1;
+
+    memcpy(cg->chunk->calls.data + cg->chunk->calls.size, &field, sizeof(field));
+    cg->chunk->calls.size += sizeof(field);
+
+    return encode_call(code, addr, routine);
+}
+
+
+/* Bit pattern with a bit set for every byte a scan with the given stride in bytes looks at
+ *
+ * Only strides that evenly divide the vector width are done with vectors,
+ * for the other strides the pattern is 0.
+ */
+static uint32_t stride_pattern(int32_t stride)
+{
+    switch (stride < 0 ? -stride : stride)
+    {
+        case 1:
+            return 0xffffffff;
+        case 2:
+            return 0x55555555;
+        case 4:
+            return 0x11111111;
+        case 8:
+            return 0x01010101;
+        case 16:
+            return 0x00010001;
+        default:
+            return 0;
+    }
+}
+
+
+/* Bit pattern for a scan with the given stride in cells, or 0 if it is not done with vectors
+ *
+ * SSE2 can not compare 64-bit cells, so those are always scanned one cell at a time.
+ */
+static uint32_t scan_pattern(int32_t stride, int cell_bits)
+{
+    if (cell_bits == 64 || stride < -16 || stride > 16)
+    {
+        return 0;
+    }
+
+    return stride_pattern(stride * (cell_bits / 8));
+}
+
+
+/* Value of a count as a cell of the given width sees it, sign-extended */
+static int32_t cell_value(int32_t count, int cell_bits)
+{
+    switch (cell_bits)
+    {
+        case 8:
+            return (int8_t) count;
+        case 16:
+            return (int16_t) count;
+        default:
+            return count;
+    }
+}
+
+
+/* REX prefix bits */
+#define REX_W           0x08    // 64-bit operand size
+#define REX_R           0x04    // extension of the ModR/M reg field
+#define REX_B           0x01    // extension of the ModR/M r/m field
+
+
+/* Encode the prefixes an operation on a cell needs, returns their length
+ *
+ * 16-bit cells get the operand size prefix, 64-bit cells get REX.W on top
+ * of the REX bits in rex.
+ */
+static size_t encode_prefix(char* code, int cell_bits, unsigned rex)
+{
+    size_t length = 0;
+
+    if (cell_bits == 16)
+    {
+        code[length++] = (char) 0x66;
+    }
+
+    if (cell_bits == 64)
+    {
+        rex |= REX_W;
+    }
+
+    if (rex != 0)
+    {
+        code[length++] = (char) (0x40 | rex);
+    }
+
+    return length;
+}
+
+
+/* Encode an immediate of the given width, 32 bits for 64-bit cells, returns its length */
+static size_t encode_immediate(char* code, int cell_bits, int32_t value)
+{
+    switch (cell_bits)
+    {
+        case 8:
+            code[0] = (int8_t) value;
+            return 1;
+
+        case 16:
+            *((int16_t*) code) = (int16_t) value;
+            return 2;
+
+        default:
+            *((int32_t*) code) = value;
+            return 4;
+    }
+}
+
+
+/* Encode the memory operand for the cell at offset, disp(%rbx), returns its length
+ *
+ * reg goes into the reg field of the ModR/M byte. The displacement is left
+ * out for the current cell, and is only 8 bits wide when the offset fits.
+ * The optimiser keeps offsets small enough that the displacement always fits
+ * in 32 bits.
+ */
+static size_t encode_cell(char* code, unsigned reg, int32_t offset, int cell_bits)
+{
+    int32_t displacement = offset * (cell_bits / 8);
+
+    if (displacement == 0)
+    {
+        code[0] = (char) (0x03 | (reg << 3));
+        return 1;
+    }
+
+    if (displacement >= INT8_MIN && displacement <= INT8_MAX)
+    {
+        code[0] = (char) (0x43 | (reg << 3));
+        code[1] = (int8_t) displacement;
+        return 2;
+    }
+
+    code[0] = (char) (0x83 | (reg << 3));
+    *((int32_t*) (code + 1)) = displacement;
+    return 5;
+}
+
+
+/* Encode an operation between a register and the cell at offset, returns its length
+ *
+ * opcode is the byte form (movb, addb and so on), the other widths use
+ * the form that follows it.
+ */
+static size_t encode_cell_op(char* code, int cell_bits, unsigned rex, unsigned char opcode, unsigned reg, int32_t offset)
+{
+    size_t length = encode_prefix(code, cell_bits, rex);
+    code[length++] = (char) (opcode | (cell_bits > 8));
+    return length + encode_cell(code + length, reg, offset, cell_bits);
+}
+
+
+/* Encode an operation with an immediate on a cell, returns its length
+ *
+ * ext selects the operation (0 for add, 7 for cmp). The cell is in the
+ * register cached refers to, or in memory at offset if cached is negative.
+ * Wider cells use the sign-extended 8-bit immediate when it fits.
+ */
+static size_t encode_immediate_op(char* code, int cell_bits, unsigned ext, int cached, int32_t offset, int32_t value)
+{
+    int short_form = cell_bits > 8 && value >= INT8_MIN && value <= INT8_MAX;
+    size_t length = encode_prefix(code, cell_bits, cached >= 0 ? REX_B : 0);
+
+    code[length++] = (char) (cell_bits == 8 ? 0x80 : short_form ? 0x83 : 0x81);
+
+    if (cached >= 0)
+    {
+        code[length++] = (char) (0xc0 | (ext << 3) | cached);
+    }
+    else
+    {
+        length += encode_cell(code + length, ext, offset, cell_bits);
+    }
+
+    return length + encode_immediate(code + length, short_form ? 8 : cell_bits, value);
+}
+
+
+/* Move the cell pointer by distance bytes, returns the number of bytes written */
+static size_t encode_move(char* code, int64_t distance)
+{
+    if (distance >= INT8_MIN && distance <= INT8_MAX)
+    {
+        /*
+         *  addq    <distance>   ,  %rbx
+         */
+        memcpy(code, "\x48\x83\xc3", 3);
+        code[3] = (int8_t) distance;
+        return 4;
+    }
+
+    if (distance >= INT32_MIN && distance <= INT32_MAX)
+    {
+        memcpy(code, "\x48\x81\xc3", 3);
+        *((int32_t*) (code + 3)) = (int32_t) distance;
+        return 7;
+    }
+
+    /* Only wide cells can be moved this far in one go
+     *
+     *  movq    <distance>   ,  %rcx
+     *  addq    %rcx         ,  %rbx
+     */
+    memcpy(code, "\x48\xb9", 2);
+    *((int64_t*) (code + 2)) = distance;
+    memcpy(code + 10, "\x48\x01\xcb", 3);
+    return 13;
+}
+
+
+/* Encode the increment of a counter of the current loop, returns its length
+ *
+ * field is the offset of the counter in the loop's profile record. Nothing
+ * is counted when the program is not instrumented.
+ */
+static size_t encode_count(const struct codegen* cg, char* code, size_t field)
+{
+    if (cg->options->instrument == NULL)
+    {
+        return 0;
+    }
+
+    /*
+     *  incq    <counter>(%rbp)
+     */
+    memcpy(code, "\x48\xff\x85", 3);
+    *((uint32_t*) (code + 3)) = loop_record(cg->loop) + field;
+    return 7;
+}
+
+
+/* Encode the test of the loop cell, returns its length */
+static size_t encode_loop_test(const struct codegen* cg, char* code)
+{
+    int cell_bits = cg->options->cell_bits;
+    size_t length;
+
+    if (cg->cache.count > 0)
+    {
+        /*
+         *  testb   %r8b            ,  %r8b
+         */
+        length = encode_prefix(code, cell_bits, REX_R | REX_B);
+        code[length++] = (char) (cell_bits == 8 ? 0x84 : 0x85);
+        code[length++] = (char) 0xc0;
+    }
+    else
+    {
+        /*
+         *  cmpb    $0           ,  (%rbx)
+         */
+        length = encode_immediate_op(code, cell_bits, 7, -1, 0, 0);
+    }
+
+    return length;
+}
+
+
+/* Does the loop end at instr branch back into the loop
+ *
+ * A rotated loop whose body ends by clearing the loop cell runs at most once.
+ */
+static int branches_back(const struct codegen* cg, const struct instr* instr)
+{
+    return !cg->options->rotate_loops || instr[-1].opcode != OP_SET || instr[-1].offset != 0 || cell_value(instr[-1].count, cg->options->cell_bits) != 0;
+}
+
+
+/* Is the addition at instr done by a vector add, without code of its own */
+static int in_vector(const struct codegen* cg, const struct instr* instr)
+{
+    size_t index = (size_t) (instr - cg->program->instrs);
+    return index >= cg->run.start && index < cg->run.start + cg->run.length && cg->run.covered[index - cg->run.start];
+}
+
+
+/* Does the code of the instruction leave ZF set exactly when the current cell is zero
+ *
+ * Additions to the current cell, and multiplications into it, end with an
+ * add or sub on the cell itself, unless the addition was part of a vector add. A loop that has just ended has tested the
+ * same cell, whether it was entered or not, unless it ran once without a
+ * test at the bottom. Instrumented loops count their iterations after this,
+ * which changes the flags.
+ */
+static int sets_zero_flag(const struct codegen* cg, const struct instr* instr)
+{
+    if (cg->options->instrument != NULL)
+    {
+        return 0;
+    }
+
+    switch (instr->opcode)
+    {
+        case OP_ADD:
+            return instr->offset == 0 && cell_value(instr->count, cg->options->cell_bits) != 0 && !in_vector(cg, instr);
+
+        case OP_MUL:
+            return instr->offset == 0;
+
+        case OP_LOOP_END:
+            return branches_back(cg, instr);
+
+        default:
+            return 0;
+    }
+}
+
+
+/* Encode the write back of the cells the loop changed in registers, returns its length */
+static size_t encode_writeback(const struct codegen* cg, char* code)
+{
+    size_t length = 0;
+
+    /*
+     *  movb    <register>      ,  <offset>(%rbx)
+     *  ...
+     */
+    for (size_t index = 0; index < cg->cache.count; ++index)
+    {
+        if (cg->cache.dirty[index])
+        {
+            length += encode_cell_op(code + length, cg->options->cell_bits, REX_R, 0x88, index, cg->cache.offsets[index]);
+        }
+    }
+
+    return length;
+}
+
+
+/* Multiply %eax (%rax for 64-bit cells) by factor into %ecx, returns number of bytes written
+ *
+ * Small factors are done with lea, the rest with imul.
+ */
+static size_t encode_multiply(char* code, int32_t factor, int wide)
+{
+    size_t length = 0;
+
+    if (wide)
+    {
+        code[length++] = (char) 0x48;
+    }
+
+    switch (factor)
+    {
+        case 2:
+            // leal    (%rax, %rax)    ,   %ecx
+            memcpy(code + length, "\x8d\x0c\x00", 3);
+            return length + 3;
+
+        case 3:
+            // leal    (%rax, %rax, 2) ,   %ecx
+            memcpy(code + length, "\x8d\x0c\x40", 3);
+            return length + 3;
+
+        case 4:
+            // leal    (, %rax, 4)     ,   %ecx
+            memcpy(code + length, "\x8d\x0c\x85\x00\x00\x00\x00", 7);
+            return length + 7;
+
+        case 5:
+            // leal    (%rax, %rax, 4) ,   %ecx
+            memcpy(code + length, "\x8d\x0c\x80", 3);
+            return length + 3;
+
+        case 8:
+            // leal    (, %rax, 8)     ,   %ecx
+            memcpy(code + length, "\x8d\x0c\xc5\x00\x00\x00\x00", 7);
+            return length + 7;
+
+        case 9:
+            // leal    (%rax, %rax, 8) ,   %ecx
+            memcpy(code + length, "\x8d\x0c\xc0", 3);
+            return length + 3;
+    }
+
+    if (factor >= INT8_MIN && factor <= INT8_MAX)
+    {
+        // imull   <factor>        ,   %eax    ,   %ecx
+        memcpy(code + length, "\x6b\xc8", 2);
+        code[length + 2] = (int8_t) factor;
+        return length + 3;
+    }
+
+    // imull   <factor>        ,   %eax    ,   %ecx
+    memcpy(code + length, "\x69\xc8", 2);
+    *((int32_t*) (code + length + 2)) = factor;
+    return length + 6;
+}
+
+
+/* Translate a single instruction, returns the number of bytes written to code
+ *
+ * addr is the position of the instruction from the beginning of the code,
+ * and loop is where the body of the matching loop starts for loop ends. Loop
+ * begins are emitted with a zero offset that is patched later.
+ *
+ * The assembly in the comments is for 8-bit cells. Wider cells use the
+ * word, long or quad forms of the same instructions on %r8w, %r8d or %r8
+ * and so on, and offsets are scaled by the cell size.
+ */
+static size_t encode(const struct codegen* cg, const struct instr* instr, uint32_t addr, uint32_t loop, char* code)
+{
+    int cell_bits = cg->options->cell_bits;
+    size_t length = 0;
+    size_t skip;
+    int32_t factor;
+    int negative;
+    unsigned reg;
+    int cached;
+
+    switch (instr->opcode)
+    {
+        case OP_MOVE:
+            /*
+             *  addq    <count>      ,  %rbx
+             */
+            return encode_move(code, (int64_t) instr->count * (cell_bits / 8));
+
+        case OP_ADD:
+            if (cell_value(instr->count, cell_bits) == 0)
+            {
+                return 0;
+            }
+
+            /*
+             *  addb    <count>      ,  <offset>(%rbx)
+             *
+             * or to the register the cell is kept in.
+             */
+            cached = cached_register(cg, instr->offset);
+            return encode_immediate_op(code, cell_bits, 0, cached, instr->offset, cell_value(instr->count, cell_bits));
+
+        case OP_SET:
+            if ((cached = cached_register(cg, instr->offset)) >= 0)
+            {
+                /*
+                 *  movb    <count>      ,  <register>
+                 *
+                 * The quad form takes a sign-extended 32-bit immediate.
+                 */
+                length = encode_prefix(code, cell_bits, REX_B);
+
+                if (cell_bits == 64)
+                {
+                    code[length++] = (char) 0xc7;
+                    code[length++] = (char) (0xc0 | cached);
+                }
+                else
+                {
+                    code[length++] = (char) ((cell_bits == 8 ? 0xb0 : 0xb8) | cached);
+                }
+
+                return length + encode_immediate(code + length, cell_bits, instr->count);
+            }
+
+            /*
+             *  movb    <count>      ,  <offset>(%rbx)
+             */
+            length = encode_cell_op(code, cell_bits, 0, 0xc6, 0, instr->offset);
+            return length + encode_immediate(code + length, cell_bits, instr->count);
+
+        case OP_MUL:
+            /*
+             *  movzbl  <source>(%rbx)          ,   %eax
+             *  <multiply %eax by |count| into %ecx>
+             *  addb    %cl                     ,   <offset>(%rbx)
+             *
+             * A factor of 1 or -1 adds or subtracts %al directly.
+             * The load is left out when the previous instruction was a
+             * multiplication from the same cell, which means %eax has it already.
+             * Either cell may be a register instead. 16-bit cells are loaded
+             * with movzwl, wider cells with a plain mov.
+             */
+            if (instr == cg->program->instrs || instr[-1].opcode != OP_MUL || instr[-1].source != instr->source)
+            {
+                if ((cached = cached_register(cg, instr->source)) >= 0 && cell_bits <= 16)
+                {
+                    memcpy(code, cell_bits == 8 ? "\x41\x0f\xb6" : "\x41\x0f\xb7", 3);
+                    code[3] = (char) (0xc0 | cached);
+                    length = 4;
+                }
+                else if (cached >= 0)
+                {
+                    code[0] = (char) (cell_bits == 64 ? 0x4c : 0x44);
+                    code[1] = (char) 0x89;
+                    code[2] = (char) (0xc0 | (cached << 3));
+                    length = 3;
+                }
+                else if (cell_bits <= 16)
+                {
+                    memcpy(code, cell_bits == 8 ? "\x0f\xb6" : "\x0f\xb7", 2);
+                    length = 2 + encode_cell(code + 2, 0, instr->source, cell_bits);
+                }
+                else
+                {
+                    length = encode_cell_op(code, cell_bits, 0, 0x8a, 0, instr->source);
+                }
+            }
+
+            // The most negative factor is its own negation, so it is added as it is
+            factor = cell_value(instr->count, cell_bits);
+            negative = factor < 0 && factor != INT32_MIN;
+            reg = 0;
+
+            if (factor != 1 && factor != -1)
+            {
+                length += encode_multiply(code + length, negative ? -factor : factor, cell_bits == 64);
+                reg = 1;
+            }
+
+            // subb for negative factors, addb for positive ones
+            if ((cached = cached_register(cg, instr->offset)) >= 0)
+            {
+                length += encode_prefix(code + length, cell_bits, REX_B);
+                code[length++] = (char) ((negative ? 0x28 : 0x00) | (cell_bits > 8));
+                code[length++] = (char) (0xc0 | (reg << 3) | cached);
+                return length;
+            }
+
+            return length + encode_cell_op(code + length, cell_bits, 0, negative ? 0x28 : 0x00, reg, instr->offset);
+
+        case OP_SCAN:
+            if (scan_pattern(instr->count, cell_bits) != 0)
+            {
+                /*
+                 *  movl    <stride pattern>     ,  %ecx
+                 *  call    <scan_right or scan_left>
+                 */
+                code[0] = (char) 0xb9;
+                *((uint32_t*) (code + 1)) = scan_pattern(instr->count, cell_bits);
+                return 5 + encode_routine_call(cg, code + 5, addr + 5, instr->count > 0 ? cg->runtime.scan_right : cg->runtime.scan_left);
+            }
+
+            /*
+             * 1:
+             *  cmpb    $0                   ,  (%rbx)
+             *  je      2f
+             *  addq    <count>              ,  %rbx
+             *  jmp     1b
+             * 2:
+             */
+            length = encode_immediate_op(code, cell_bits, 7, -1, 0, 0);
+            code[length] = (char) 0x74;
+            skip = encode_move(code + length + 2, (int64_t) instr->count * (cell_bits / 8));
+            code[length + 1] = (char) (skip + 2);
+            code[length + 2 + skip] = (char) 0xeb;
+            code[length + 3 + skip] = (char) -(length + skip + 4);
+            return length + skip + 4;
+
+        case OP_LOOP_BEGIN:
+            /* Loops are rotated, so that every iteration only takes the branch
+             * at the bottom. The loop begin guards the first iteration. It loads
+             * the cells the loop keeps in registers, and tests the loop cell.
+             * Without rotation, every iteration jumps back to this test.
+             *
+             *  incq    <entries>(%rbp)                 # only when instrumented
+             *  movb    <offset>(%rbx)  ,  <register>
+             *  ...
+             *  testb   %r8b            ,  %r8b
+             *  je      <past loop end>                 # rel8 if it reaches
+             */
+            length = encode_count(cg, code, offsetof(struct loop_profile, entries));
+
+            for (size_t index = 0; index < cg->cache.count; ++index)
+            {
+                length += encode_cell_op(code + length, cell_bits, REX_R, 0x8a, index, cg->cache.offsets[index]);
+            }
+
+            length += encode_loop_test(cg, code + length);
+
+            if (cg->far[cg->loop] & FAR_GUARD)
+            {
+                memcpy(code + length, "\x0f\x84\x00\x00\x00\x00", 6);
+                return length + 6;
+            }
+
+            memcpy(code + length, "\x74\x00", 2);
+            return length + 2;
+
+        case OP_LOOP_END:
+            /*
+             *  incq    <iterations>(%rbp)              # only when instrumented
+             *  testb   %r8b            ,  %r8b
+             *  jne     <loop body>                     # rel8 if it reaches
+             *
+             * The test is left out when the last instruction of the body
+             * has set the flags for the loop cell already, and the branch
+             * as well when it cleared the loop cell, as the body then runs
+             * at most once. The loop begin jumps past this, to where the
+             * cells the loop changed in registers are written back.
+             *
+             *  movb    <register>      ,  <offset>(%rbx)
+             *  ...
+             */
+            length = encode_count(cg, code, offsetof(struct loop_profile, iterations));
+
+            if (!branches_back(cg, instr))
+            {
+                return length + encode_writeback(cg, code + length);
+            }
+
+            if (!cg->options->rotate_loops)
+            {
+                /*
+                 *  jmp     <loop test>                     # rel8 if it reaches
+                 */
+                if (cg->far[cg->loop] & FAR_BACK)
+                {
+                    code[length] = (char) 0xe9;
+                    *((uint32_t*) (code + length + 1)) = loop - (addr + length + 5);
+                    length += 5;
+                }
+                else
+                {
+                    code[length] = (char) 0xeb;
+                    code[length + 1] = (char) (loop - (addr + length + 2));
+                    length += 2;
+                }
+
+                return length + encode_writeback(cg, code + length);
+            }
+
+            if (!sets_zero_flag(cg, instr - 1))
+            {
+                length += encode_loop_test(cg, code + length);
+            }
+
+            if (cg->far[cg->loop] & FAR_BACK)
+            {
+                memcpy(code + length, "\x0f\x85", 2);
+                *((uint32_t*) (code + length + 2)) = loop - (addr + length + 6);
+                length += 6;
+            }
+            else
+            {
+                code[length] = (char) 0x75;
+                code[length + 1] = (char) (loop - (addr + length + 2));
+                length += 2;
+            }
+
+            return length + encode_writeback(cg, code + length);
+
+        case OP_WRITE:
+            if (cg->options->buffered_output)
+            {
+                /* Only the lowest byte of the cell is printed
+                 *
+                 *  movb    <offset>(%rbx)       ,  %al
+                 *  call    putc
+                 */
+                code[0] = (char) 0x8a;
+                length = 1 + encode_cell(code + 1, 0, instr->offset, cell_bits);
+                return length + encode_routine_call(cg, code + length, addr + length, cg->runtime.putc);
+            }
+
+            /*
+             *  movq    <sys_write>          ,  %rax
+             *  movq    $1                   ,  %rdi    # file number 1 = stdout
+             *  leaq    <offset>(%rbx)       ,  %rsi    # move address of cell we're going to print
+             *  movq    $1                   ,  %rdx    # how many bytes
+             *  syscall
+             */
+            memcpy(code, "\x48\xc7\xc0\x00\x00\x00\x00\x48\xc7\xc7\x01\x00\x00\x00\x48\x8d", 16);
+            *((uint32_t*) (code + 3)) = cg->target->sys_write;
+            length = 16 + encode_cell(code + 16, 6, instr->offset, cell_bits);
+            memcpy(code + length, "\x48\xc7\xc2\x01\x00\x00\x00\x0f\x05", 9);
+            return length + 9;
+
+        case OP_READ:
+            if (cg->options->buffered_output)
+            {
+                // Make sure prompts are visible before blocking on input
+                length += encode_routine_call(cg, code, addr, cg->runtime.flush);
+            }
+
+            if (cg->options->buffered_input)
+            {
+                /*
+                 *  call    getc
+                 *  testl   %eax         ,  %eax
+                 *  js      1f                              # end of file, leave cell as is
+                 *  movb    %al          ,  <offset>(%rbx)
+                 * 1:
+                 *
+                 * The test is only needed when end of file leaves the cell alone.
+                 */
+                length += encode_routine_call(cg, code + length, addr + length, cg->runtime.getc);
+
+                if (cg->options->eof != EOF_NO_CHANGE)
+                {
+                    return length + encode_cell_op(code + length, cell_bits, 0, 0x88, 0, instr->offset);
+                }
+
+                memcpy(code + length, "\x85\xc0\x78\x00", 4);
+                skip = encode_cell_op(code + length + 4, cell_bits, 0, 0x88, 0, instr->offset);
+                code[length + 3] = (char) skip;
+                return length + 4 + skip;
+            }
+
+            /*
+             *  movq    <sys_read>           ,  %rax
+             *  movq    $0                   ,  %rdi    # file number 0 = stdin
+             *  leaq    <offset>(%rbx)       ,  %rsi    # move address of cell we're going to read to
+             *  movq    $1                   ,  %rdx    # how many bytes
+             *  syscall
+             */
+            memcpy(code + length, "\x48\xc7\xc0\x00\x00\x00\x00\x48\xc7\xc7\x00\x00\x00\x00\x48\x8d", 16);
+            *((uint32_t*) (code + length + 3)) = cg->target->sys_read;
+            length += 16;
+            length += encode_cell(code + length, 6, instr->offset, cell_bits);
+            memcpy(code + length, "\x48\xc7\xc2\x01\x00\x00\x00\x0f\x05", 9);
+            length += 9;
+
+            if (cell_bits == 8)
+            {
+                if (cg->options->eof != EOF_NO_CHANGE)
+                {
+                    /*
+                     *  testq   %rax         ,  %rax
+                     *  jg      1f
+                     *  movb    <EOF value>  ,  <offset>(%rbx)
+                     * 1:
+                     */
+                    memcpy(code + length, "\x48\x85\xc0\x7f\x00\xc6", 6);
+                    code[length + 4] = (char) (2 + encode_cell(code + length + 6, 0, instr->offset, cell_bits));
+                    length += 5 + code[length + 4];
+                    code[length - 1] = cg->options->eof == EOF_ZERO ? 0x00 : 0xff;
+                }
+                return length;
+            }
+
+            /* The byte only replaced the lowest byte of a wider cell
+             *
+             *  testq   %rax         ,  %rax
+             *  jle     1f
+             *  movzbl  <offset>(%rbx)       ,  %eax
+             *  movl    %eax         ,  <offset>(%rbx)
+             *  jmp     2f
+             * 1:
+             *  movl    <EOF value>  ,  <offset>(%rbx)
+             * 2:
+             *
+             * Without an EOF value, the jump and the store are left out.
+             */
+            memcpy(code + length, "\x48\x85\xc0\x7e\x00\x0f\xb6", 7);
+            skip = length + 4;
+            length += 7;
+            length += encode_cell(code + length, 0, instr->offset, cell_bits);
+            length += encode_cell_op(code + length, cell_bits, 0, 0x88, 0, instr->offset);
+
+            if (cg->options->eof != EOF_NO_CHANGE)
+            {
+                size_t store = length + 2;
+                size_t store_length = encode_cell_op(code + store, cell_bits, 0, 0xc6, 0, instr->offset);
+                store_length += encode_immediate(code + store + store_length, cell_bits, cg->options->eof == EOF_ZERO ? 0 : -1);
+
+                code[length] = (char) 0xeb;
+                code[length + 1] = (char) store_length;
+                length += 2;
+                code[skip] = (char) (length - (skip + 1));
+                return length + store_length;
+            }
+
+            code[skip] = (char) (length - (skip + 1));
+            return length;
+    }
+
+    return 0;
+}
+
+
+static uint32_t hash_constant(const uint8_t* bytes)
+{
+    uint32_t hash = 2166136261u;
+
+    // FNV-1a
+    for (size_t byte = 0; byte < 16; ++byte)
+    {
+        hash = (hash ^ bytes[byte]) * 16777619u;
+    }
+
+    return hash;
+}
+
+
+/* Find the constant in the pool, or add it if it is not there yet */
+static int add_constant(struct constant_pool* pool, const uint8_t* bytes, uint32_t* constant)
 {
-    struct page* curr = (struct page*) malloc(sizeof(struct page) - 1 + page_size);
+    uint32_t count = (uint32_t) (pool->data.size / 16);
+    size_t slot;
+    int status;
+
+    // Keep the table at most half full
+    if (2 * ((size_t) count + 1) > pool->capacity)
+    {
+        size_t capacity = pool->capacity > 0 ? 2 * pool->capacity : 256;
+        uint32_t* slots = (uint32_t*) calloc(capacity, sizeof(uint32_t));
+        if (slots == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return -ENOMEM;
+        }
+
+        for (uint32_t number = 0; number < count; ++number)
+        {
+            for (slot = hash_constant(pool->data.data + 16 * number) & (capacity - 1); slots[slot] != 0; slot = (slot + 1) & (capacity - 1));
+            slots[slot] = number + 1;
+        }
+
+        free(pool->slots);
+        pool->slots = slots;
+        pool->capacity = capacity;
+    }
+
+    for (slot = hash_constant(bytes) & (pool->capacity - 1); pool->slots[slot] != 0; slot = (slot + 1) & (pool->capacity - 1))
+    {
+        if (memcmp(pool->data.data + 16 * (pool->slots[slot] - 1), bytes, 16) == 0)
+        {
+            *constant = pool->slots[slot] - 1;
+            return 0;
+        }
+    }
+
+    status = buffer_append(&pool->data, bytes, 16);
+    if (status == 0)
+    {
+        pool->slots[slot] = count + 1;
+        *constant = count;
+    }
+
+    return status;
+}
+
+
+/* Place the constants after the code and point the loads at them
+ *
+ * The code is mapped read-only, so the constants are too. Padding puts them
+ * on a 16 byte boundary from the start of the code.
+ */
+static int add_constant_pool(struct buffer* code, const struct constant_pool* pool)
+{
+    const struct fixup* fixups = (const struct fixup*) pool->fixups.data;
+    size_t padding = (16 - code->size % 16) % 16;
+    uint32_t base;
+    int status;
+
+    if (pool->data.size == 0)
+    {
+        return 0;
+    }
+
+    status = buffer_reserve(code, padding + pool->data.size);
+    if (status < 0)
+    {
+        return status;
+    }
+
+    code->size += encode_nops((char*) code->data + code->size, padding);
+    base = (uint32_t) code->size;
+    memcpy(code->data + code->size, pool->data.data, pool->data.size);
+    code->size += pool->data.size;
+
+    // Displacements are relative to the end of the load, which ends with them
+    for (size_t fixup = 0; fixup < pool->fixups.size / sizeof(struct fixup); ++fixup)
+    {
+        *((uint32_t*) (code->data + fixups[fixup].field)) = base + 16 * fixups[fixup].constant - (fixups[fixup].field + 4);
+    }
+
+    return 0;
+}
+
+
+static void free_constant_pool(struct constant_pool* pool)
+{
+    buffer_free(&pool->data);
+    buffer_free(&pool->fixups);
+    free(pool->slots);
+    pool->slots = NULL;
+    pool->capacity = 0;
+}
+
+
+/* Add a constant to width bytes of cells from offset on with a single vector add */
+static int emit_vector_add(struct codegen* cg, struct buffer* code, int32_t offset, size_t width, const uint8_t* constant)
+{
+    static const unsigned char add_opcodes[] = { [1] = 0xfc, [2] = 0xfd, [4] = 0xfe, [8] = 0xd4 };
+    int cell_bits = cg->options->cell_bits;
+    struct fixup fixup;
+    size_t length;
+    char* bytes;
+    int status;
+
+    status = add_constant(&cg->chunk->constants, constant, &fixup.constant);
+    if (status == 0)
+    {
+        status = buffer_reserve(code, MAX_INSTR_SIZE);
+    }
+
+    if (status < 0)
+    {
+        return status;
+    }
+
+    /*
+     *  movdqu  <offset>(%rbx)      ,   %xmm0       # movq for 8 bytes
+     *  movdqu  <constant>(%rip)    ,   %xmm1
+     *  paddb   %xmm1               ,   %xmm0       # paddw or paddd for wider cells
+     *  movdqu  %xmm0               ,   <offset>(%rbx)
+     *
+     * Neither the cells nor the constants are known to be on a 16 byte
+     * boundary on every target, so the constant can not be an operand of
+     * paddb, which would require that.
+     */
+    bytes = (char*) code->data + code->size;
+    memcpy(bytes, width == 16 ? "\xf3\x0f\x6f" : "\xf3\x0f\x7e", 3);
+    length = 3 + encode_cell(bytes + 3, 0, offset, cell_bits);
+
+    memcpy(bytes + length, width == 16 ? "\xf3\x0f\x6f\x0d\x00\x00\x00\x00" : "\xf3\x0f\x7e\x0d\x00\x00\x00\x00", 8);
+    fixup.field = (uint32_t) (code->size + length + 4);
+    length += 8;
+
+    memcpy(bytes + length, "\x66\x0f\x00\xc1", 4);
+    bytes[length + 2] = (char) add_opcodes[cell_bits / 8];
+    length += 4;
+
+    memcpy(bytes + length, width == 16 ? "\xf3\x0f\x7f" : "\x66\x0f\xd6", 3);
+    length += 3 + encode_cell(bytes + length + 3, 0, offset, cell_bits);
+
+    code->size += length;
+    return buffer_append(&cg->chunk->constants.fixups, &fixup, sizeof(fixup));
+}
+
+
+/* Gather the additions in a row from index on into vector adds, and emit those
+ *
+ * The changes to every cell are added up, and cells close enough together
+ * are changed with one paddb of 16 bytes, or failing that of 8 bytes, as
+ * long as at least MIN_VECTOR_CELLS of them are. The cells in between are
+ * added 0. Vectors never reach beyond the lowest and highest cell of the
+ * run, which the additions touch anyway, so they can not fault where the
+ * additions would not. Cells kept in registers are left to the additions.
+ */
+static int emit_vector_adds(struct codegen* cg, struct buffer* code, size_t index)
+{
+    const struct instr* instrs = cg->program->instrs;
+    size_t cell_bytes = cg->options->cell_bits / 8;
+    struct vector_run* run = &cg->run;
+    int32_t offsets[MAX_VECTOR_RUN];
+    int64_t deltas[MAX_VECTOR_RUN];
+    uint8_t done[MAX_VECTOR_RUN];
+    int32_t lowest;
+    int32_t highest;
+    size_t cells = 0;
+    size_t cell;
+    int status = 0;
+
+    // Cells by offset, with what the run adds to them
+    run->start = index;
+    for (run->length = 0; run->length < MAX_VECTOR_RUN && index + run->length < cg->program->length; ++run->length)
+    {
+        const struct instr* instr = &instrs[index + run->length];
+
+        if (instr->opcode != OP_ADD)
+        {
+            break;
+        }
+
+        run->covered[run->length] = 0;
+        if (cached_register(cg, instr->offset) >= 0 || cell_value(instr->count, cg->options->cell_bits) == 0)
+        {
+            continue;
+        }
+
+        for (cell = 0; cell < cells && offsets[cell] < instr->offset; ++cell);
+        if (cell == cells || offsets[cell] != instr->offset)
+        {
+            memmove(offsets + cell + 1, offsets + cell, (cells - cell) * sizeof(offsets[0]));
+            memmove(deltas + cell + 1, deltas + cell, (cells - cell) * sizeof(deltas[0]));
+            offsets[cell] = instr->offset;
+            deltas[cell] = 0;
+            done[cells++] = 0;
+        }
+
+        deltas[cell] += instr->count;
+    }
+
+    /* Vectors only span the cells the run adds to in memory
+     *
+     * Additions of zero and cells kept in registers do not widen the span,
+     * so no vector reaches past the cells the program really changes.
+     */
+    if (cells == 0)
+    {
+        return 0;
+    }
 
-    if (prev != NULL)
+    lowest = offsets[0];
+    highest = offsets[cells - 1];
+
+    for (size_t width = 16; width >= 8 && status == 0; width /= 2)
     {
-        prev->next = curr;
+        int32_t lanes = (int32_t) (width / cell_bytes);
+
+        if (lanes < MIN_VECTOR_CELLS || (int64_t) highest - lowest + 1 < lanes)
+        {
+            continue;
+        }
+
+        for (size_t first = 0; first < cells && status == 0; ++first)
+        {
+            // The last vectors of the run end at its highest cell
+            int32_t start = offsets[first] <= highest - lanes + 1 ? offsets[first] : highest - lanes + 1;
+            uint8_t constant[16] = { 0 };
+            int32_t count = 0;
+
+            if (done[first])
+            {
+                continue;
+            }
+
+            for (cell = 0; cell < cells; ++cell)
+            {
+                count += !done[cell] && offsets[cell] >= start && offsets[cell] < start + lanes;
+            }
+
+            if (count < MIN_VECTOR_CELLS)
+            {
+                continue;
+            }
+
+            // Cells are little endian, so the low bytes of the sum are the cell value
+            for (cell = 0; cell < cells; ++cell)
+            {
+                if (!done[cell] && offsets[cell] >= start && offsets[cell] < start + lanes)
+                {
+                    memcpy(constant + (offsets[cell] - start) * cell_bytes, &deltas[cell], cell_bytes);
+                    done[cell] = 1;
+                }
+            }
+
+            status = emit_vector_add(cg, code, start, width, constant);
+        }
     }
 
-    if (curr != NULL)
+    for (size_t addition = 0; addition < run->length; ++addition)
     {
-        curr->next = NULL;
-        curr->size = 0;
+        const struct instr* instr = &instrs[index + addition];
+
+        for (cell = 0; cell < cells && offsets[cell] != instr->offset; ++cell);
+        run->covered[addition] = cell < cells && done[cell];
     }
 
-    return curr;
+    return status;
 }
 
 
-static struct page* add_to_page(struct page* page, size_t page_size, size_t length, const char* code)
+/* Emit the code of every instruction of the chunk
+ *
+ * Branches take the forms in cg->far. If a short branch does not reach,
+ * its loop gets the long form, and 1 is returned to have the code emitted
+ * again. Branches only ever get longer, so this ends with every branch in
+ * its shortest form that reaches, and 0 is returned.
+ */
+static int emit_program(struct codegen* cg, struct open_loop* open, uint32_t* addresses)
 {
-    struct page* curr_page = page;
+    const struct program* program = cg->program;
+    struct chunk* chunk = cg->chunk;
+    struct buffer* code = &chunk->code;
+    size_t align = cg->options->align_loops;
+    uint32_t numbered = chunk->loop;
+    size_t depth = 0;
+    int relaxed = 0;
+    int status = 0;
+
+    cg->cache.count = 0;
+    cg->run.start = 0;
+    cg->run.length = 0;
+    code->size = 0;
+    chunk->calls.size = 0;
+    chunk->constants.data.size = 0;
+    chunk->constants.fixups.size = 0;
+    if (chunk->constants.slots != NULL)
+    {
+        memset(chunk->constants.slots, 0, chunk->constants.capacity * sizeof(uint32_t));
+    }
 
-    while (length > 0 && curr_page != NULL)
+    for (size_t index = chunk->first; index < chunk->last && status == 0; ++index)
     {
-        if (curr_page->size == page_size)
+        const struct instr* instr = &program->instrs[index];
+        uint32_t addr = code->size;
+        uint32_t loop = 0;
+        char scratch[MAX_INSTR_SIZE];
+
+        if (addresses != NULL)
+        {
+            addresses[index] = addr;
+        }
+
+        switch (instr->opcode)
+        {
+            case OP_LOOP_BEGIN:
+                allocate_registers(program, index, &cg->cache);
+                if (!cg->options->cell_registers || rarely_iterates(cg, instr))
+                {
+                    cg->cache.count = 0;
+                }
+                cg->loop = numbered++;
+                open[depth].number = cg->loop;
+                break;
+
+            case OP_LOOP_END:
+                --depth;
+                loop = cg->options->rotate_loops ? open[depth].body : open[depth].test;
+                cg->loop = open[depth].number;
+                break;
+
+            default:
+                break;
+        }
+
+        // Additions in a row are done with vector adds where enough cells are close together
+        if (cg->options->vector_adds && instr->opcode == OP_ADD && index >= cg->run.start + cg->run.length)
+        {
+            status = emit_vector_adds(cg, code, index);
+        }
+
+        // Instructions are encoded straight into the buffer
+        if (status == 0)
+        {
+            status = buffer_reserve(code, MAX_INSTR_SIZE);
+        }
+
+        if (status == 0)
+        {
+            status = buffer_reserve(&chunk->calls, 2 * sizeof(uint32_t));
+        }
+
+        if (status == 0 && !(instr->opcode == OP_ADD && in_vector(cg, instr)))
+        {
+            code->size += encode(cg, instr, code->size, loop, (char*) code->data + code->size);
+        }
+
+        /* Hot loops start their body on a fresh line of the instruction cache
+         *
+         * Only rotated loops are aligned, as loops that jump back to their
+         * test at the top would run through the padding on every iteration.
+         */
+        if (status == 0 && instr->opcode == OP_LOOP_BEGIN)
         {
-            curr_page = alloc_page(curr_page, page_size);
-            if (curr_page == NULL)
+            open[depth].guard = code->size;
+            open[depth].test = code->size - ((cg->far[cg->loop] & FAR_GUARD) ? 6 : 2) - encode_loop_test(cg, scratch);
+            if (align > 0 && cg->options->rotate_loops && is_hot(cg, index))
             {
-                fprintf(stderr, "Out of memory\n");
-                return NULL;
+                code->size += encode_nops((char*) code->data + code->size, (align - (chunk->base + code->size) % align) % align);
             }
+            open[depth++].body = code->size;
         }
 
-        curr_page->data[curr_page->size++] = *code++;
-        --length;
+        // Loop begin jumps past the branch back into the loop
+        if (status == 0 && instr->opcode == OP_LOOP_END)
+        {
+            uint32_t past = code->size - encode_writeback(cg, scratch);
+            int64_t distance = (int64_t) past - open[depth].guard;
+
+            if (cg->far[cg->loop] & FAR_GUARD)
+            {
+                *((uint32_t*) (code->data + open[depth].guard - 4)) = (uint32_t) distance;
+            }
+            else if (distance <= INT8_MAX)
+            {
+                code->data[open[depth].guard - 1] = (uint8_t) distance;
+            }
+            else
+            {
+                cg->far[cg->loop] |= FAR_GUARD;
+                relaxed = 1;
+            }
+
+            // The branch back ends where the loop begin jumps to
+            if (branches_back(cg, instr) && !(cg->far[cg->loop] & FAR_BACK) && (int64_t) loop - past < INT8_MIN)
+            {
+                cg->far[cg->loop] |= FAR_BACK;
+                relaxed = 1;
+            }
+
+            cg->cache.count = 0;
+        }
     }
 
-    return curr_page;
+    return status < 0 ? status : relaxed;
 }
 
 
-static const struct token* find_chain_end(const struct token* current_token, uint32_t* offset, uint32_t max)
+/* Emit the code of a chunk, with its own copy of the code generation state
+ *
+ * Every branch stays inside the chunk, so the branch forms of its loops only
+ * depend on the chunk, and are relaxed here on their own.
+ */
+static int emit_chunk(const struct codegen* shared, struct chunk* chunk, uint32_t* addresses)
 {
-    // TODO: Rewrite only to return the chain end
-    const struct token* ptr = current_token;
-    uint32_t count = 1;
+    struct codegen cg = *shared;
+    struct open_loop* open;
+    int status;
+
+    cg.chunk = chunk;
 
-    while (ptr->next != NULL && ptr->next->symbol == current_token->symbol)
+    // Loops whose branch past the loop has not been patched yet
+    open = (struct open_loop*) malloc(((chunk->last - chunk->first) / 2 + 1) * sizeof(struct open_loop));
+    if (open == NULL)
     {
-        ptr = ptr->next;
-        if (++count == max)
-        {
-            break;
-        }
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    status = buffer_init(&chunk->code, 1 << 16);
+    if (status == 0)
+    {
+        status = buffer_init(&chunk->calls, 1 << 8);
+    }
+
+    if (status == 0)
+    {
+        status = buffer_init(&chunk->constants.data, 1 << 8);
     }
-    
-    if (offset != NULL)
+
+    if (status == 0)
+    {
+        status = buffer_init(&chunk->constants.fixups, 1 << 8);
+    }
+
+    // Some branches got longer, so emit the chunk again
+    while (status == 0 && (status = emit_program(&cg, open, addresses)) > 0)
+    {
+        status = 0;
+    }
+
+    free(open);
+    return status;
+}
+
+
+static void free_chunk(struct chunk* chunk)
+{
+    buffer_free(&chunk->code);
+    buffer_free(&chunk->calls);
+    free_constant_pool(&chunk->constants);
+}
+
+
+/* Divide the program into chunks of at least CHUNK_SIZE instructions, returns how many there are
+ *
+ * There is room for program->length / CHUNK_SIZE + 1 chunks.
+ */
+static size_t split_program(const struct program* program, struct chunk* chunks)
+{
+    size_t count = 0;
+    uint32_t loops = 0;
+    size_t depth = 0;
+
+    chunks[0].first = 0;
+    chunks[0].loop = 0;
+
+    for (size_t index = 0; index < program->length; ++index)
     {
-        *offset = count;
+        switch (program->instrs[index].opcode)
+        {
+            case OP_LOOP_BEGIN:
+                if (depth == 0 && index - chunks[count].first >= CHUNK_SIZE)
+                {
+                    chunks[count++].last = index;
+                    chunks[count].first = index;
+                    chunks[count].loop = loops;
+                }
+                ++depth;
+                ++loops;
+                break;
+
+            case OP_LOOP_END:
+                --depth;
+                break;
+
+            default:
+                break;
+        }
     }
 
-    return ptr;
+    chunks[count].last = program->length;
+    return count + 1;
 }
 
 
-static uint32_t calculate_loop_offset(const struct token* begin, const struct token* end, uint32_t offset)
+/* Chunks waiting for a thread to emit their code */
+struct chunk_queue
 {
-    const struct token* token_chain;
+    const struct codegen*   cg;
+    struct chunk*           chunks;
+    size_t                  count;
+    size_t                  next;       // next chunk to be taken
+    uint32_t*               addresses;
+    pthread_mutex_t         lock;
+};
 
-    switch (begin->symbol)
+
+/* Emit chunks until there are none left, run by every thread */
+static void* emit_chunks(void* argument)
+{
+    struct chunk_queue* queue = (struct chunk_queue*) argument;
+
+    for (;;)
     {
-        case INCR_CELL:
-        case DECR_CELL:
-            token_chain = find_chain_end(begin, NULL, 0x7f);
-            offset += 4;
-            begin = token_chain;
-            break;
+        size_t index;
 
-        case INCR_DATA:
-        case DECR_DATA:
-            token_chain = find_chain_end(begin, NULL, 0x7f);
-            offset += 5;
-            begin = token_chain;
-            break;
+        pthread_mutex_lock(&queue->lock);
+        index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
 
-        case WRITE_DATA:
-            offset += 30;
-            break;
+        if (index >= queue->count)
+        {
+            return NULL;
+        }
 
-        case READ_DATA:
-            offset += 30;
-            break;
+        queue->chunks[index].status = emit_chunk(queue->cg, &queue->chunks[index], queue->addresses);
+    }
+}
 
-        case LOOP_BEGIN:
-            offset += 6 + 2 + 4;
-            break;
 
-        case LOOP_END:
-            offset += 1 + 4; 
-            break;
+/* Append the code of a chunk, fix up its calls and merge its constants into the pool */
+static int add_chunk(struct buffer* code, const struct chunk* chunk, struct constant_pool* pool, uint32_t* addresses)
+{
+    const struct fixup* fixups = (const struct fixup*) chunk->constants.fixups.data;
+    const uint32_t* calls = (const uint32_t*) chunk->calls.data;
+    uint32_t base = (uint32_t) code->size;
+    uint32_t* numbers;
+    int status;
+
+    numbers = (uint32_t*) malloc((chunk->constants.data.size / 16 + 1) * sizeof(uint32_t));
+    if (numbers == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    status = buffer_append(code, chunk->code.data, chunk->code.size);
+
+    // Calls were encoded as if the chunk started at address 0
+    for (size_t call = 0; status == 0 && call < chunk->calls.size / sizeof(uint32_t); ++call)
+    {
+        *((uint32_t*) (code->data + base + calls[call])) -= base;
+    }
+
+    if (status == 0 && addresses != NULL)
+    {
+        for (size_t index = chunk->first; index < chunk->last; ++index)
+        {
+            addresses[index] += base;
+        }
+    }
+
+    // Constants are added in the order the chunk first used them, as they would be without chunks
+    for (size_t constant = 0; status == 0 && constant < chunk->constants.data.size / 16; ++constant)
+    {
+        status = add_constant(pool, chunk->constants.data.data + 16 * constant, &numbers[constant]);
     }
 
-    if (begin == end)
+    for (size_t load = 0; status == 0 && load < chunk->constants.fixups.size / sizeof(struct fixup); ++load)
     {
-        return offset;
+        struct fixup fixup = { base + fixups[load].field, numbers[fixups[load].constant] };
+        status = buffer_append(&pool->fixups, &fixup, sizeof(fixup));
     }
 
-    // Don't check for NULL here because the parser should have already matched all loops
-    return calculate_loop_offset(begin->next, end, offset);
+    free(numbers);
+    return status;
 }
 
 
-int compile(const struct token* token_string, struct page** page_list, size_t page_size, uint64_t data_addr)
+int compile(const struct program* program, struct buffer* code, uint64_t data_addr, const struct target* target, const struct options* options, uint32_t* addresses)
 {
-    struct page* curr_page = alloc_page(NULL, page_size);
-    *page_list = curr_page;
-    const struct token* last_token;
+    int status;
+    struct codegen cg;
+    struct chunk* chunks;
+    struct chunk_queue queue;
+    struct constant_pool constants;
+    pthread_t* threads = NULL;
+    size_t started = 0;
+    int scans = 0;
+    uint64_t loop_count = 0;
+    uint64_t tape_addr;
+
+    cg.program = program;
+    cg.target = target;
+    cg.options = options;
+    cg.cache.count = 0;
+    cg.loop = 0;
+    memset(&cg.runtime, 0, sizeof(cg.runtime));
 
-    char byte_code[8];
-    uint32_t addr = 0;
-    uint32_t offset = 0;
+    status = buffer_init(code, 1 << 16);
+    if (status < 0)
+    {
+        return status;
+    }
 
     /* Save stack frame and point registers to data
      *
      *   al = working register
      *  rbp = data base address
-     *   dx = current cell offset
+     *  rbx = address of the current cell, which system calls leave alone
+     *  r12 = stack pointer on entry
      *
      *  pushq 	%rbx
      *  pushq	%rbp
      *  pushq	%rsi
      *  pushq   %rdi
-     *  movq	%rsp		    ,	%rbx
+     *  pushq   %r12
+     *  movq	%rsp		    ,	%r12
      *  xorq	%rax		    ,	%rax
      *  movq	<data address>  ,	%rbp
-     *  xorq	%rdx		    ,	%rdx
      */
-    curr_page = add_to_page(curr_page, page_size, 12,"\x53\x55\x56\x57\x48\x89\xe3\x48\x31\xc0\x48\xbd");
-    curr_page = add_to_page(curr_page, page_size, 8, (char*) &data_addr);
-    curr_page = add_to_page(curr_page, page_size, 3, "\x48\x31\xd2");
+    status = buffer_append(code, "\x53\x55\x56\x57\x41\x54\x49\x89\xe4\x48\x31\xc0\x48\xbd", 14);
+    if (status == 0)
+    {
+        status = buffer_append(code, &data_addr, 8);
+    }
 
-    while (token_string != NULL && curr_page != NULL)
+    tape_addr = data_addr + TAPE_OFFSET;
+    if (status == 0 && target->map_tape)
     {
-        switch (token_string->symbol)
-        {
-            case INCR_CELL:
-                /*
-                 *  addw    <chain count>   ,   %dx
-                 */
-                last_token = find_chain_end(token_string, &offset, 0x7f);
+        status = add_tape_mapping(code, target, tape_addr, options->tape_size);
+    }
 
-                byte_code[0] = 0x66;
-                byte_code[1] = 0x83;
-                byte_code[2] = 0xc2;
-                byte_code[3] = (uint8_t) offset;
+    if (status == 0 && options->buffered_input && options->mmap_input)
+    {
+        status = add_input_mapping(code, target);
+    }
 
-                curr_page = add_to_page(curr_page, page_size, 4, byte_code);
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        scans |= program->instrs[index].opcode == OP_SCAN && scan_pattern(program->instrs[index].count, options->cell_bits) != 0;
+        loop_count += program->instrs[index].opcode == OP_LOOP_BEGIN;
+    }
 
-                addr += 4;
-                token_string = last_token;
-                break;
+    if (options->instrument != NULL && loop_count > MAX_PROFILE_LOOPS)
+    {
+        fprintf(stderr, "Too many loops to instrument, at most %zu are supported\n", (size_t) MAX_PROFILE_LOOPS);
+        return -E2BIG;
+    }
 
-            case DECR_CELL:
-                /*
-                 *  subw    <chain count>   ,   %dx
-                 */
-                last_token = find_chain_end(token_string, &offset, 0x7f);
+    if (options->instrument != NULL && strlen(options->instrument) >= PROFILE_PATH_SIZE)
+    {
+        fprintf(stderr, "Profile path is too long\n");
+        return -ENAMETOOLONG;
+    }
 
-                byte_code[0] = 0x66;
-                byte_code[1] = 0x83;
-                byte_code[2] = 0xea;
-                byte_code[3] = (uint8_t) offset;
+    if (status == 0 && scans && options->avx2)
+    {
+        status = add_cpu_detection(code);
+    }
 
-                curr_page = add_to_page(curr_page, page_size, 4, byte_code);
+    /* Start at the first cell, which lies past the runtime state and a guard region
+     *
+     *  movq    <tape address>  ,   %rbx
+     */
+    if (status == 0)
+    {
+        status = buffer_append(code, "\x48\xbb", 2);
+    }
 
-                addr += 4;
-                token_string = last_token;
-                break;
+    if (status == 0)
+    {
+        status = buffer_append(code, &tape_addr, 8);
+    }
 
-            case INCR_DATA:
-                /*
-                 *  addb    <value>      ,   (%rbp, %rdx)
-                 */
-                last_token = find_chain_end(token_string, &offset, 0x7f);
+    if (status == 0 && (options->buffered_output || options->buffered_input || scans))
+    {
+        status = add_runtime(code, &cg.runtime, target, options, scans);
+    }
 
-                byte_code[0] = 0x80;
-                byte_code[1] = 0x44;
-                byte_code[2] = 0x15;
-                byte_code[3] = 0x00;
-                byte_code[4] = (uint8_t) offset;
+    // The chunks of the program, and the branch forms of all loops, which start out short
+    chunks = (struct chunk*) calloc(program->length / CHUNK_SIZE + 1, sizeof(struct chunk));
+    cg.far = (uint8_t*) calloc(loop_count + 1, sizeof(uint8_t));
+    if (chunks == NULL || cg.far == NULL)
+    {
+        free(chunks);
+        free(cg.far);
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
 
-                curr_page = add_to_page(curr_page, page_size, 5, byte_code);
+    memset(&constants, 0, sizeof(constants));
+    if (status == 0)
+    {
+        status = buffer_init(&constants.data, 1 << 8);
+    }
 
-                addr += 5;
-                token_string = last_token;
-                break;
+    if (status == 0)
+    {
+        status = buffer_init(&constants.fixups, 1 << 8);
+    }
 
-            case DECR_DATA:
-                /*
-                 *  subb    <value>      ,   (%rbp, %rdx)
-                 */
-                last_token = find_chain_end(token_string, &offset, 0x7f);
+    /* Chunks are emitted by a pool of threads, as if each started at address 0
+     *
+     * Only the first chunk does not start on a multiple of the loop alignment,
+     * so it is told where it really starts to align its loops. The code is the
+     * same however many threads there are.
+     */
+    queue.cg = &cg;
+    queue.chunks = chunks;
+    queue.count = split_program(program, chunks);
+    queue.next = 0;
+    queue.addresses = addresses;
+    chunks[0].base = (uint32_t) code->size;
 
-                byte_code[0] = 0x80;
-                byte_code[1] = 0x6c;
-                byte_code[2] = 0x15;
-                byte_code[3] = 0x00;
-                byte_code[4] = (uint8_t) offset;
+    if (status == 0 && (status = pthread_mutex_init(&queue.lock, NULL)) != 0)
+    {
+        fprintf(stderr, "Could not create lock: %s\n", strerror(status));
+        status = -status;
+    }
 
-                curr_page = add_to_page(curr_page, page_size, 5, byte_code);
+    if (status == 0)
+    {
+        size_t jobs = (size_t) options->jobs < queue.count ? (size_t) options->jobs : queue.count;
 
-                addr += 5;
-                token_string = last_token;
-                break;
+        threads = (pthread_t*) malloc(jobs * sizeof(pthread_t));
+        if (threads == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            status = -ENOMEM;
+        }
 
-            case LOOP_BEGIN:
-                /*
-                 *  movb    (%rbp, %rdx) ,  %al
-                 *  cmpb    $0           ,  %al
-                 *  je      <calculated address>
-                 *
-                 */
-                offset = calculate_loop_offset(token_string->next, ((const struct loop*) token_string)->match, 0);
+        // The calling thread takes part too, so fewer threads only makes it slower
+        while (threads != NULL && started + 1 < jobs && pthread_create(&threads[started], NULL, emit_chunks, &queue) == 0)
+        {
+            ++started;
+        }
 
-                byte_code[0] = 0x0f;
-                byte_code[1] = 0x84;
-                *((uint32_t*) (byte_code + 2)) = offset;
+        if (threads != NULL)
+        {
+            emit_chunks(&queue);
+        }
 
-                addr += 12;
-                curr_page = add_to_page(curr_page, page_size, 6, "\x8a\x44\x15\x00\x3c\x00");
-                curr_page = add_to_page(curr_page, page_size, 6, byte_code);
-                break;
+        for (size_t thread = 0; thread < started; ++thread)
+        {
+            pthread_join(threads[thread], NULL);
+        }
 
-            case LOOP_END:
-                /*
-                 *  jump    <address of comparison>
-                 */
-                offset = calculate_loop_offset(((const struct loop*) token_string)->match->next, token_string, 0);
+        free(threads);
+        pthread_mutex_destroy(&queue.lock);
+    }
 
-                byte_code[0] = 0xe9;
-                *((uint32_t*) (byte_code + 1)) = -offset - 12;
+    for (size_t chunk = 0; chunk < queue.count; ++chunk)
+    {
+        size_t align = options->align_loops;
 
-                curr_page = add_to_page(curr_page, page_size, 5, byte_code);
-                addr += 5;
+        if (status == 0)
+        {
+            status = chunks[chunk].status;
+        }
 
-                break;
+        if (status == 0 && chunk > 0 && align > 0)
+        {
+            status = buffer_reserve(code, align);
+        }
 
-            case WRITE_DATA:
-                /*
-                 *  movq    $0x2000004   ,  %rax    # 4 = syscall write, 2000000 = UNIX/BSD mask
-                 *  movq    $1           ,  %rdi    # file number 1 = stdout
-                 *  leaq    (%rbp, %rdx) ,  %rsi    # move address of cell we're going to print
-                 *  pushq   %rdx                    # save register
-                 *  movq    $1           ,  %rdx    # how many bytes
-                 *  syscall
-                 *  popq    %rdx
-                 */
-                addr += 30;
-                curr_page = add_to_page(curr_page, page_size, 30,
-                        "\x48\xc7\xc0\x04\x00\x00\x02\x48\xc7\xc7\x01\x00\x00\x00\x48\x8d"
-                        "\x74\x15\x00\x52\x48\xc7\xc2\x01\x00\x00\x00\x0f\x05\x5a"
-                        );
-                break;
+        if (status == 0 && chunk > 0 && align > 0)
+        {
+            code->size += encode_nops((char*) code->data + code->size, (align - code->size % align) % align);
+        }
 
-            case READ_DATA:
-                /*
-                 *  movq    $0x2000003   ,  %rax    # 3 = syscall read, 2000000 = UNIX/BSD mask
-                 *  movq    $0           ,  %rdi    # file number 0 = stdin
-                 *  leaq    (%rbp, %rdx) ,  %rsi    # move address of cell we're going to print
-                 *  pushq   %rdx                    # save register
-                 *  movq    $1           ,  %rdx    # how many bytes
-                 *  syscall
-                 *  popq    %rdx
-                 */
-                addr += 30;
-                curr_page = add_to_page(curr_page, page_size, 30,
-                        "\x48\xc7\xc0\x03\x00\x00\x02\x48\xc7\xc7\x00\x00\x00\x00\x48\x8d"
-                        "\x74\x15\x00\x52\x48\xc7\xc2\x01\x00\x00\x00\x0f\x05\x5a"
-                        );
-                break;
+        if (status == 0)
+        {
+            status = add_chunk(code, &chunks[chunk], &constants, addresses);
         }
 
-        token_string = token_string->next;
+        free_chunk(&chunks[chunk]);
     }
 
-    if (curr_page != NULL)
+    free(chunks);
+    free(cg.far);
+
+    if (status == 0 && addresses != NULL)
     {
-        /* Extract return value from current cell and restore stack frame
-         *
-         *  movb	(%rbp, %rdx)	,	%al
-         *  movq	%rbx		    ,	%rsp
-         *  popq    %rdi
-         *  popq	%rsi
-         *  popq	%rbp
-         *  popq	%rbx
-         *  retq
+        addresses[program->length] = (uint32_t) code->size;
+    }
+
+    if (status == 0)
+    {
+        status = buffer_reserve(code, MAX_INSTR_SIZE);
+    }
+
+    if (status < 0)
+    {
+        free_constant_pool(&constants);
+        return status;
+    }
+
+    if (options->buffered_output)
+    {
+        code->size += encode_call((char*) code->data + code->size, code->size, cg.runtime.flush);
+    }
+
+    if (options->instrument != NULL)
+    {
+        status = add_profile_writer(code, target, program, options->instrument, loop_count);
+    }
+
+    if (status == 0)
+    {
+        status = buffer_reserve(code, MAX_INSTR_SIZE);
+    }
+
+    if (status < 0)
+    {
+        free_constant_pool(&constants);
+        return status;
+    }
+
+    /* Extract return value from current cell and restore stack frame
+     *
+     *  movb	(%rbx)	        ,	%al
+     *  movq	%r12		    ,	%rsp
+     *  popq    %r12
+     *  popq    %rdi
+     *  popq	%rsi
+     *  popq	%rbp
+     *  popq	%rbx
+     *
+     */
+    memcpy(code->data + code->size, "\x8a\x03\x4c\x89\xe4\x41\x5c\x5f\x5e\x5d\x5b", 11);
+    code->size += 11;
+
+    if (target->exit_syscall)
+    {
+        /* There is nothing to return to, so terminate the process
          *
+         *  movzbl  %al             ,   %edi
+         *  movq    <sys_exit>      ,   %rax
+         *  syscall
          */
-        curr_page = add_to_page(curr_page, page_size, 12,
-                "\x8a\x44\x15\x00\x48\x89\xdc\x5f\x5e\x5d\x5b\xc3");
+        memcpy(code->data + code->size, "\x0f\xb6\xf8\x48\xc7\xc0\x00\x00\x00\x00\x0f\x05", 12);
+        *((uint32_t*) (code->data + code->size + 6)) = target->sys_exit;
+        code->size += 12;
     }
     else
     {
-        return -ENOMEM;
+        /* Return to the loader
+         *
+         *  retq
+         */
+        code->data[code->size++] = 0xc3;
     }
 
-    return 0;
+    status = add_constant_pool(code, &constants);
+    if (status == 0 && addresses != NULL)
+    {
+        addresses[program->length + 1] = (uint32_t) (code->size - constants.data.size);
+    }
+
+    free_constant_pool(&constants);
+    return status;
 }
@@ -2,11 +2,51 @@
 #define __COMPILER_H__
 
 #include <stdint.h>
-#include "page.h"
-#include "token.h"
+#include "buffer.h"
+#include "ir.h"
+#include "layout.h"
+#include "profile.h"
+#include "target.h"
 
 
-/* Translate the parse tree to x86-64 byte code for UNIX/BSD/Mac OS X */
-int compile(const struct token* token_string, struct page** page_list, size_t page_size, uint64_t data_addr);
+/* What ',' does to the cell when there is no more input */
+enum eof_behaviour
+{
+    EOF_NO_CHANGE,      // leave the cell value as it is
+    EOF_ZERO,           // set the cell to 0
+    EOF_MINUS_ONE       // set the cell to -1 (255)
+};
+
+
+/* Code generation options */
+struct options
+{
+    int                 buffered_output;    // collect output and flush it on exit, on input and when full
+    int                 buffered_input;     // read input in large chunks instead of one byte per ','
+    int                 mmap_input;         // read input straight from memory if stdin is a regular file
+    enum eof_behaviour  eof;                // what ',' does at end of file
+    int                 avx2;               // use AVX2 for scans when the CPU supports it
+    int                 cell_bits;          // cell width, 8, 16, 32 or 64
+    uint64_t            tape_size;          // size of the tape in bytes, in whole pages
+    int                 align_loops;        // start the bodies of hot loops at a multiple of this many bytes, or 0
+    const char*         instrument;         // count how often loops run and write that to this file on exit, or NULL
+    const struct profile* profile;          // counters of an instrumented run to guide code generation, or NULL
+    int                 jobs;               // threads that generate code, at least 1
+    int                 cell_registers;     // keep the cells of innermost loops in registers
+    int                 rotate_loops;       // test loops at the bottom instead of jumping back to the top
+    int                 vector_adds;        // add to rows of nearby cells with one vector add
+};
+
+
+/* Translate the program to x86-64 byte code for the given target
+ *
+ * The code buffer is initialised here and must be released by the caller,
+ * also when compilation fails. If addresses is not NULL, it receives where
+ * the code of every instruction starts, where the code of the last one
+ * ends at index program->length, and where the constants the code loads
+ * start at index program->length + 1. The constants take up the rest of the
+ * buffer.
+ */
+int compile(const struct program* program, struct buffer* code, uint64_t data_addr, const struct target* target, const struct options* options, uint32_t* addresses);
 
 #endif
@@ -0,0 +1,856 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+#include "disasm.h"
+
+
+/* Rough latencies in cycles, for a recent x86-64 core with memory accesses hitting L1
+ *
+ * A store counts as the cycle it takes to issue, not the store-to-load
+ * forwarding delay a later load of the same address sees.
+ */
+#define LATENCY_NONE        0
+#define LATENCY_ALU         1
+#define LATENCY_SHIFT_CL    2
+#define LATENCY_MULTIPLY    3
+#define LATENCY_BITSCAN     3
+#define LATENCY_MASK        3
+#define LATENCY_LOAD        5
+#define LATENCY_RMW         6
+#define LATENCY_DIVIDE      25
+#define LATENCY_XGETBV      10
+#define LATENCY_SYSCALL     100
+
+
+/* Register numbers that mean something special in a memory operand */
+#define NO_REGISTER         -1
+#define RIP                 16
+
+
+static const char* const alu_names[8] = { "add", "or", "adc", "sbb", "and", "sub", "xor", "cmp" };
+static const char* const shift_names[8] = { "rol", "ror", "rcl", "rcr", "shl", "shr", "sal", "sar" };
+static const char* const conditions[16] = { "o", "no", "b", "ae", "e", "ne", "be", "a", "s", "ns", "p", "np", "l", "ge", "le", "g" };
+
+static const char* const registers64[16] = { "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15" };
+static const char* const registers32[16] = { "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d" };
+static const char* const registers16[16] = { "ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w" };
+static const char* const registers8[16] = { "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b" };
+static const char* const legacy8[8] = { "al", "cl", "dl", "bl", "ah", "ch", "dh", "bh" };
+
+
+/* Prefixes and position of the instruction being decoded */
+struct decoder
+{
+    const unsigned char*    code;
+    size_t                  size;
+    size_t                  pos;        // next byte to decode
+    unsigned                rex;        // REX prefix, or the bits a VEX prefix implies
+    int                     operand16;  // 0x66 prefix
+    int                     rep;        // 0xf3 prefix
+    int                     vex;        // VEX prefix
+    unsigned                vex_reg;    // extra source register of a VEX instruction
+    int                     vex_256;    // VEX instruction works on ymm registers
+    unsigned                vex_pp;     // prefix implied by VEX: 1 = 0x66, 2 = 0xf3, 3 = 0xf2
+    int                     rip;        // has an operand relative to the end of the instruction
+    int32_t                 rip_disp;   // displacement of that operand
+    int                     truncated;  // ran past the end of the code
+};
+
+
+/* Register or memory operand described by a ModRM byte */
+struct operand
+{
+    int         memory;
+    unsigned    reg;        // register number, if not memory
+    int         base;       // base register, RIP or NO_REGISTER
+    int         index;      // index register or NO_REGISTER
+    int         scale;
+    int32_t     disp;
+};
+
+
+static uint64_t fetch(struct decoder* d, size_t bytes)
+{
+    uint64_t value = 0;
+
+    if (d->pos + bytes > d->size)
+    {
+        d->truncated = 1;
+        d->pos = d->size;
+        return 0;
+    }
+
+    for (size_t byte = 0; byte < bytes; ++byte)
+    {
+        value |= (uint64_t) d->code[d->pos + byte] << (8 * byte);
+    }
+
+    d->pos += bytes;
+    return value;
+}
+
+
+/* Fetch a signed immediate or displacement */
+static int64_t fetch_signed(struct decoder* d, size_t bytes)
+{
+    uint64_t value = fetch(d, bytes);
+
+    switch (bytes)
+    {
+        case 1:
+            return (int8_t) value;
+
+        case 2:
+            return (int16_t) value;
+
+        case 4:
+            return (int32_t) value;
+
+        default:
+            return (int64_t) value;
+    }
+}
+
+
+/* Width of the operands of instructions that default to 32 bits */
+static int operand_size(const struct decoder* d)
+{
+    return (d->rex & 8) ? 64 : d->operand16 ? 16 : 32;
+}
+
+
+static char suffix(int size)
+{
+    switch (size)
+    {
+        case 8:
+            return 'b';
+
+        case 16:
+            return 'w';
+
+        case 64:
+            return 'q';
+
+        default:
+            return 'l';
+    }
+}
+
+
+static const char* register_name(const struct decoder* d, unsigned reg, int size)
+{
+    static char vector[8];
+
+    switch (size)
+    {
+        case 8:
+            return d->rex != 0 ? registers8[reg] : legacy8[reg & 7];
+
+        case 16:
+            return registers16[reg];
+
+        case 32:
+            return registers32[reg];
+
+        case 64:
+            return registers64[reg];
+
+        default:
+            snprintf(vector, sizeof(vector), "%s%u", size == 256 ? "ymm" : "xmm", reg);
+            return vector;
+    }
+}
+
+
+/* Decode a ModRM byte with its SIB byte and displacement, returns the register field */
+static unsigned decode_modrm(struct decoder* d, struct operand* rm)
+{
+    unsigned modrm = (unsigned) fetch(d, 1);
+    unsigned mod = modrm >> 6;
+    unsigned reg = ((modrm >> 3) & 7) | ((d->rex & 4) << 1);
+
+    memset(rm, 0, sizeof(*rm));
+
+    if (mod == 3)
+    {
+        rm->reg = (modrm & 7) | ((d->rex & 1) << 3);
+        return reg;
+    }
+
+    rm->memory = 1;
+    rm->index = NO_REGISTER;
+    rm->scale = 1;
+
+    if ((modrm & 7) == 4)
+    {
+        unsigned sib = (unsigned) fetch(d, 1);
+        unsigned index = ((sib >> 3) & 7) | ((d->rex & 2) << 2);
+
+        rm->scale = 1 << (sib >> 6);
+        rm->index = index == 4 ? NO_REGISTER : (int) index;
+        rm->base = (int) ((sib & 7) | ((d->rex & 1) << 3));
+
+        if ((sib & 7) == 5 && mod == 0)
+        {
+            rm->base = NO_REGISTER;
+            rm->disp = (int32_t) fetch_signed(d, 4);
+        }
+    }
+    else if ((modrm & 7) == 5 && mod == 0)
+    {
+        rm->base = RIP;
+        rm->disp = (int32_t) fetch_signed(d, 4);
+        d->rip = 1;
+        d->rip_disp = rm->disp;
+    }
+    else
+    {
+        rm->base = (int) ((modrm & 7) | ((d->rex & 1) << 3));
+    }
+
+    if (mod == 1)
+    {
+        rm->disp = (int32_t) fetch_signed(d, 1);
+    }
+    else if (mod == 2)
+    {
+        rm->disp = (int32_t) fetch_signed(d, 4);
+    }
+
+    return reg;
+}
+
+
+/* Append text to the operands built up so far */
+static void append(char* text, size_t capacity, const char* format, ...)
+{
+    size_t length = strlen(text);
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(text + length, capacity - length, format, args);
+    va_end(args);
+}
+
+
+static void append_signed(char* text, size_t capacity, int64_t value)
+{
+    if (value < 0)
+    {
+        append(text, capacity, "-0x%llx", (unsigned long long) -(uint64_t) value);
+    }
+    else
+    {
+        append(text, capacity, "0x%llx", (unsigned long long) value);
+    }
+}
+
+
+static void append_operand(const struct decoder* d, char* text, size_t capacity, const struct operand* operand, int size)
+{
+    if (!operand->memory)
+    {
+        append(text, capacity, "%%%s", register_name(d, operand->reg, size));
+        return;
+    }
+
+    if (operand->disp != 0 || operand->base == NO_REGISTER)
+    {
+        append_signed(text, capacity, operand->disp);
+    }
+
+    if (operand->base == NO_REGISTER && operand->index == NO_REGISTER)
+    {
+        return;
+    }
+
+    append(text, capacity, "(");
+    if (operand->base == RIP)
+    {
+        append(text, capacity, "%%rip");
+    }
+    else if (operand->base != NO_REGISTER)
+    {
+        append(text, capacity, "%%%s", registers64[operand->base]);
+    }
+
+    if (operand->index != NO_REGISTER)
+    {
+        append(text, capacity, ",%%%s,%d", registers64[operand->index], operand->scale);
+    }
+    append(text, capacity, ")");
+}
+
+
+static void append_immediate(char* text, size_t capacity, int64_t value)
+{
+    append(text, capacity, "$");
+    append_signed(text, capacity, value);
+}
+
+
+/* Fill in the instruction text from a mnemonic and up to three operands, in AT&T order */
+static void format_instr(struct disasm* instr, const char* mnemonic, const char* operands)
+{
+    snprintf(instr->text, sizeof(instr->text), "%-10s%s", mnemonic, operands);
+}
+
+
+/* Operands of a two operand instruction between a register and a register or memory operand */
+static void reg_rm(const struct decoder* d, char* text, size_t capacity, unsigned reg, int reg_size, const struct operand* rm, int rm_size, int to_rm)
+{
+    if (to_rm)
+    {
+        append(text, capacity, "%%%s, ", register_name(d, reg, reg_size));
+        append_operand(d, text, capacity, rm, rm_size);
+    }
+    else
+    {
+        append_operand(d, text, capacity, rm, rm_size);
+        append(text, capacity, ", %%%s", register_name(d, reg, reg_size));
+    }
+}
+
+
+static void imm_rm(const struct decoder* d, char* text, size_t capacity, int64_t value, const struct operand* rm, int size)
+{
+    append_immediate(text, capacity, value);
+    append(text, capacity, ", ");
+    append_operand(d, text, capacity, rm, size);
+}
+
+
+/* Decode an SSE2 or AVX2 instruction from the 0x0f map, returns 0 if it is not known */
+static int decode_vector(struct decoder* d, unsigned opcode, struct disasm* instr)
+{
+    char operands[64] = "";
+    char mnemonic[16];
+    struct operand rm;
+    unsigned reg;
+    int size = d->vex_256 ? 256 : 128;
+    const char* name;
+    int latency;
+    int prefixed = d->vex ? d->vex_pp == 1 : d->operand16;
+
+    switch (opcode)
+    {
+        case 0x6f:
+        case 0x7f:
+            if (d->vex ? d->vex_pp == 2 : d->rep)
+            {
+                name = "movdqu";
+            }
+            else if (prefixed)
+            {
+                name = "movdqa";
+            }
+            else
+            {
+                return 0;
+            }
+
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, opcode == 0x7f);
+            latency = rm.memory && opcode == 0x6f ? LATENCY_LOAD + 1 : LATENCY_ALU;
+            break;
+
+        case 0x7e:
+        case 0xd6:
+            // Only the 64-bit moves between memory and the low half of a register
+            if (d->vex || (opcode == 0x7e ? !d->rep : !prefixed))
+            {
+                return 0;
+            }
+
+            name = "movq";
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, opcode == 0xd6);
+            latency = rm.memory && opcode == 0x7e ? LATENCY_LOAD + 1 : LATENCY_ALU;
+            break;
+
+        case 0xd7:
+            if (!prefixed)
+            {
+                return 0;
+            }
+
+            name = "pmovmskb";
+            reg = decode_modrm(d, &rm);
+            append_operand(d, operands, sizeof(operands), &rm, size);
+            append(operands, sizeof(operands), ", %%%s", register_name(d, reg, 32));
+            latency = LATENCY_MASK;
+            break;
+
+        case 0x74: case 0x75: case 0x76:
+        case 0xfc: case 0xfd: case 0xfe: case 0xd4:
+        case 0xef: case 0xdb: case 0xeb:
+            if (!prefixed)
+            {
+                return 0;
+            }
+
+            switch (opcode)
+            {
+                case 0x74: name = "pcmpeqb"; break;
+                case 0x75: name = "pcmpeqw"; break;
+                case 0x76: name = "pcmpeqd"; break;
+                case 0xfc: name = "paddb"; break;
+                case 0xfd: name = "paddw"; break;
+                case 0xfe: name = "paddd"; break;
+                case 0xd4: name = "paddq"; break;
+                case 0xdb: name = "pand"; break;
+                case 0xeb: name = "por"; break;
+                default: name = "pxor"; break;
+            }
+
+            reg = decode_modrm(d, &rm);
+            append_operand(d, operands, sizeof(operands), &rm, size);
+            if (d->vex)
+            {
+                append(operands, sizeof(operands), ", %%%s", register_name(d, d->vex_reg, size));
+            }
+            append(operands, sizeof(operands), ", %%%s", register_name(d, reg, size));
+            latency = rm.memory ? LATENCY_LOAD + 1 + LATENCY_ALU : LATENCY_ALU;
+            break;
+
+        case 0x77:
+            if (!d->vex || d->vex_pp != 0)
+            {
+                return 0;
+            }
+
+            format_instr(instr, d->vex_256 ? "vzeroall" : "vzeroupper", "");
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        default:
+            return 0;
+    }
+
+    snprintf(mnemonic, sizeof(mnemonic), "%s%s", d->vex ? "v" : "", name);
+    format_instr(instr, mnemonic, operands);
+    instr->latency = latency;
+    return 1;
+}
+
+
+/* Decode an instruction from the 0x0f map, returns 0 if it is not known */
+static int decode_0f(struct decoder* d, struct disasm* instr)
+{
+    unsigned opcode = (unsigned) fetch(d, 1);
+    char operands[64] = "";
+    char mnemonic[16];
+    struct operand rm;
+    unsigned reg;
+    int size = operand_size(d);
+
+    if (d->vex)
+    {
+        return decode_vector(d, opcode, instr);
+    }
+
+    if (opcode >= 0x80 && opcode <= 0x8f)
+    {
+        int64_t rel = fetch_signed(d, 4);
+        snprintf(mnemonic, sizeof(mnemonic), "j%s", conditions[opcode & 15]);
+        append(operands, sizeof(operands), "0x%llx", (unsigned long long) (d->pos + rel));
+        format_instr(instr, mnemonic, operands);
+        instr->latency = LATENCY_ALU;
+        return 1;
+    }
+
+    switch (opcode)
+    {
+        case 0x01:
+            if (fetch(d, 1) != 0xd0)
+            {
+                return 0;
+            }
+
+            format_instr(instr, "xgetbv", "");
+            instr->latency = LATENCY_XGETBV;
+            return 1;
+
+        case 0x05:
+            format_instr(instr, "syscall", "");
+            instr->latency = LATENCY_SYSCALL;
+            return 1;
+
+        case 0x1f:
+            decode_modrm(d, &rm);
+            append_operand(d, operands, sizeof(operands), &rm, size);
+            snprintf(mnemonic, sizeof(mnemonic), "nop%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_NONE;
+            return 1;
+
+        case 0xa2:
+            format_instr(instr, "cpuid", "");
+            instr->latency = LATENCY_SYSCALL;
+            return 1;
+
+        case 0xaf:
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, 0);
+            snprintf(mnemonic, sizeof(mnemonic), "imul%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_MULTIPLY + (rm.memory ? LATENCY_LOAD : 0);
+            return 1;
+
+        case 0xb6: case 0xb7: case 0xbe: case 0xbf:
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, opcode & 1 ? 16 : 8, 0);
+            snprintf(mnemonic, sizeof(mnemonic), "mov%c%c%c", opcode < 0xbe ? 'z' : 's', suffix(opcode & 1 ? 16 : 8), suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = rm.memory ? LATENCY_LOAD : LATENCY_ALU;
+            return 1;
+
+        case 0xbc: case 0xbd:
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, 0);
+            if (d->rep)
+            {
+                snprintf(mnemonic, sizeof(mnemonic), "%s%c", opcode == 0xbc ? "tzcnt" : "lzcnt", suffix(size));
+            }
+            else
+            {
+                snprintf(mnemonic, sizeof(mnemonic), "%s%c", opcode == 0xbc ? "bsf" : "bsr", suffix(size));
+            }
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_BITSCAN + (rm.memory ? LATENCY_LOAD : 0);
+            return 1;
+
+        default:
+            return decode_vector(d, opcode, instr);
+    }
+}
+
+
+/* Decode one instruction, returns 0 if it is not known */
+static int decode(struct decoder* d, struct disasm* instr)
+{
+    unsigned opcode;
+    char operands[64] = "";
+    char mnemonic[16];
+    struct operand rm;
+    unsigned reg;
+    int size;
+    int64_t value;
+
+    // Legacy prefixes, then REX or VEX
+    for (;;)
+    {
+        opcode = (unsigned) fetch(d, 1);
+        if (opcode == 0x66)
+        {
+            d->operand16 = 1;
+        }
+        else if (opcode == 0xf3)
+        {
+            d->rep = 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (opcode >= 0x40 && opcode <= 0x4f)
+    {
+        d->rex = opcode;
+        opcode = (unsigned) fetch(d, 1);
+    }
+    else if (opcode == 0xc5)
+    {
+        unsigned vex = (unsigned) fetch(d, 1);
+
+        d->vex = 1;
+        d->rex = (vex & 0x80) ? 0 : 4;
+        d->vex_reg = (~vex >> 3) & 15;
+        d->vex_256 = (vex >> 2) & 1;
+        d->vex_pp = vex & 3;
+        opcode = 0x0f;
+    }
+
+    size = operand_size(d);
+
+    // add, or, adc, sbb, and, sub, xor and cmp in their register and accumulator forms
+    if (opcode < 0x40 && (opcode & 7) < 6)
+    {
+        const char* name = alu_names[opcode >> 3];
+        int compare = (opcode >> 3) == 7;
+
+        switch (opcode & 7)
+        {
+            case 0: case 1: case 2: case 3:
+                size = opcode & 1 ? size : 8;
+                reg = decode_modrm(d, &rm);
+                reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, !(opcode & 2));
+
+                if (!rm.memory)
+                {
+                    instr->latency = LATENCY_ALU;
+                }
+                else
+                {
+                    instr->latency = (opcode & 2) || compare ? LATENCY_LOAD + LATENCY_ALU : LATENCY_RMW;
+                }
+                break;
+
+            default:
+                size = opcode & 1 ? size : 8;
+                value = fetch_signed(d, size == 8 ? 1 : size == 16 ? 2 : 4);
+                append_immediate(operands, sizeof(operands), value);
+                append(operands, sizeof(operands), ", %%%s", register_name(d, 0, size));
+                instr->latency = LATENCY_ALU;
+                break;
+        }
+
+        snprintf(mnemonic, sizeof(mnemonic), "%s%c", name, suffix(size));
+        format_instr(instr, mnemonic, operands);
+        return 1;
+    }
+
+    if (opcode >= 0x70 && opcode <= 0x7f)
+    {
+        value = fetch_signed(d, 1);
+        snprintf(mnemonic, sizeof(mnemonic), "j%s", conditions[opcode & 15]);
+        append(operands, sizeof(operands), "0x%llx", (unsigned long long) (d->pos + value));
+        format_instr(instr, mnemonic, operands);
+        instr->latency = LATENCY_ALU;
+        return 1;
+    }
+
+    switch (opcode)
+    {
+        case 0x0f:
+            return decode_0f(d, instr);
+
+        case 0x50: case 0x51: case 0x52: case 0x53: case 0x54: case 0x55: case 0x56: case 0x57:
+        case 0x58: case 0x59: case 0x5a: case 0x5b: case 0x5c: case 0x5d: case 0x5e: case 0x5f:
+            append(operands, sizeof(operands), "%%%s", registers64[(opcode & 7) | ((d->rex & 1) << 3)]);
+            format_instr(instr, opcode < 0x58 ? "pushq" : "popq", operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0x69:
+        case 0x6b:
+            reg = decode_modrm(d, &rm);
+            value = fetch_signed(d, opcode == 0x6b ? 1 : size == 16 ? 2 : 4);
+            append_immediate(operands, sizeof(operands), value);
+            append(operands, sizeof(operands), ", ");
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, 0);
+            snprintf(mnemonic, sizeof(mnemonic), "imul%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_MULTIPLY + (rm.memory ? LATENCY_LOAD : 0);
+            return 1;
+
+        case 0x80:
+        case 0x81:
+        case 0x83:
+            size = opcode == 0x80 ? 8 : size;
+            reg = decode_modrm(d, &rm) & 7;
+            value = fetch_signed(d, opcode != 0x81 ? 1 : size == 16 ? 2 : 4);
+            imm_rm(d, operands, sizeof(operands), value, &rm, size);
+            snprintf(mnemonic, sizeof(mnemonic), "%s%c", alu_names[reg], suffix(size));
+            format_instr(instr, mnemonic, operands);
+
+            if (!rm.memory)
+            {
+                instr->latency = LATENCY_ALU;
+            }
+            else
+            {
+                instr->latency = reg == 7 ? LATENCY_LOAD + LATENCY_ALU : LATENCY_RMW;
+            }
+            return 1;
+
+        case 0x84:
+        case 0x85:
+            size = opcode == 0x84 ? 8 : size;
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, 1);
+            snprintf(mnemonic, sizeof(mnemonic), "test%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = rm.memory ? LATENCY_LOAD + LATENCY_ALU : LATENCY_ALU;
+            return 1;
+
+        case 0x88: case 0x89: case 0x8a: case 0x8b:
+            size = opcode & 1 ? size : 8;
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, !(opcode & 2));
+            snprintf(mnemonic, sizeof(mnemonic), "mov%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = rm.memory && (opcode & 2) ? LATENCY_LOAD : LATENCY_ALU;
+            return 1;
+
+        case 0x8d:
+            reg = decode_modrm(d, &rm);
+            reg_rm(d, operands, sizeof(operands), reg, size, &rm, size, 0);
+            snprintf(mnemonic, sizeof(mnemonic), "lea%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0x90:
+            format_instr(instr, d->operand16 ? "xchgw" : "nop", d->operand16 ? "%ax, %ax" : "");
+            instr->latency = LATENCY_NONE;
+            return 1;
+
+        case 0xb0: case 0xb1: case 0xb2: case 0xb3: case 0xb4: case 0xb5: case 0xb6: case 0xb7:
+            append_immediate(operands, sizeof(operands), fetch_signed(d, 1));
+            append(operands, sizeof(operands), ", %%%s", register_name(d, (opcode & 7) | ((d->rex & 1) << 3), 8));
+            format_instr(instr, "movb", operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0xb8: case 0xb9: case 0xba: case 0xbb: case 0xbc: case 0xbd: case 0xbe: case 0xbf:
+            append_immediate(operands, sizeof(operands), fetch_signed(d, size / 8));
+            append(operands, sizeof(operands), ", %%%s", register_name(d, (opcode & 7) | ((d->rex & 1) << 3), size));
+            snprintf(mnemonic, sizeof(mnemonic), size == 64 ? "movabsq" : "mov%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0xc0: case 0xc1: case 0xd0: case 0xd1: case 0xd2: case 0xd3:
+            size = opcode & 1 ? size : 8;
+            reg = decode_modrm(d, &rm) & 7;
+
+            if (opcode <= 0xc1)
+            {
+                append_immediate(operands, sizeof(operands), fetch_signed(d, 1));
+            }
+            else
+            {
+                append(operands, sizeof(operands), opcode <= 0xd1 ? "$0x1" : "%%cl");
+            }
+            append(operands, sizeof(operands), ", ");
+            append_operand(d, operands, sizeof(operands), &rm, size);
+
+            snprintf(mnemonic, sizeof(mnemonic), "%s%c", shift_names[reg], suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = (opcode >= 0xd2 ? LATENCY_SHIFT_CL : LATENCY_ALU) + (rm.memory ? LATENCY_RMW - LATENCY_ALU : 0);
+            return 1;
+
+        case 0xc3:
+            format_instr(instr, "retq", "");
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0xc6:
+        case 0xc7:
+            size = opcode == 0xc6 ? 8 : size;
+            if ((decode_modrm(d, &rm) & 7) != 0)
+            {
+                return 0;
+            }
+
+            value = fetch_signed(d, size == 8 ? 1 : size == 16 ? 2 : 4);
+            imm_rm(d, operands, sizeof(operands), value, &rm, size);
+            snprintf(mnemonic, sizeof(mnemonic), "mov%c", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0xe8:
+        case 0xe9:
+        case 0xeb:
+            value = fetch_signed(d, opcode == 0xeb ? 1 : 4);
+            append(operands, sizeof(operands), "0x%llx", (unsigned long long) (d->pos + value));
+            format_instr(instr, opcode == 0xe8 ? "callq" : "jmp", operands);
+            instr->latency = LATENCY_ALU;
+            return 1;
+
+        case 0xf6:
+        case 0xf7:
+            size = opcode == 0xf6 ? 8 : size;
+            reg = decode_modrm(d, &rm) & 7;
+
+            switch (reg)
+            {
+                case 0:
+                    value = fetch_signed(d, size == 8 ? 1 : size == 16 ? 2 : 4);
+                    imm_rm(d, operands, sizeof(operands), value, &rm, size);
+                    snprintf(mnemonic, sizeof(mnemonic), "test%c", suffix(size));
+                    instr->latency = rm.memory ? LATENCY_LOAD + LATENCY_ALU : LATENCY_ALU;
+                    break;
+
+                case 2:
+                case 3:
+                    append_operand(d, operands, sizeof(operands), &rm, size);
+                    snprintf(mnemonic, sizeof(mnemonic), "%s%c", reg == 2 ? "not" : "neg", suffix(size));
+                    instr->latency = rm.memory ? LATENCY_RMW : LATENCY_ALU;
+                    break;
+
+                case 4:
+                case 5:
+                    append_operand(d, operands, sizeof(operands), &rm, size);
+                    snprintf(mnemonic, sizeof(mnemonic), "%s%c", reg == 4 ? "mul" : "imul", suffix(size));
+                    instr->latency = LATENCY_MULTIPLY + (rm.memory ? LATENCY_LOAD : 0);
+                    break;
+
+                case 6:
+                case 7:
+                    append_operand(d, operands, sizeof(operands), &rm, size);
+                    snprintf(mnemonic, sizeof(mnemonic), "%s%c", reg == 6 ? "div" : "idiv", suffix(size));
+                    instr->latency = LATENCY_DIVIDE;
+                    break;
+
+                default:
+                    return 0;
+            }
+
+            format_instr(instr, mnemonic, operands);
+            return 1;
+
+        case 0xfe:
+        case 0xff:
+            size = opcode == 0xfe ? 8 : size;
+            reg = decode_modrm(d, &rm) & 7;
+            if (reg > 1)
+            {
+                return 0;
+            }
+
+            append_operand(d, operands, sizeof(operands), &rm, size);
+            snprintf(mnemonic, sizeof(mnemonic), "%s%c", reg == 0 ? "inc" : "dec", suffix(size));
+            format_instr(instr, mnemonic, operands);
+            instr->latency = rm.memory ? LATENCY_RMW : LATENCY_ALU;
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+
+void disassemble(const unsigned char* code, size_t size, size_t offset, struct disasm* instr)
+{
+    struct decoder d;
+
+    memset(&d, 0, sizeof(d));
+    d.code = code;
+    d.size = size;
+    d.pos = offset;
+
+    if (decode(&d, instr) && !d.truncated)
+    {
+        instr->length = d.pos - offset;
+
+        // Show where a RIP-relative operand points, like branch targets
+        if (d.rip)
+        {
+            size_t length = strlen(instr->text);
+            snprintf(instr->text + length, sizeof(instr->text) - length, "  # 0x%llx", (unsigned long long) (d.pos + d.rip_disp));
+        }
+        return;
+    }
+
+    // Unknown or cut off, so list it one byte at a time
+    snprintf(instr->text, sizeof(instr->text), "%-10s0x%02x", ".byte", code[offset]);
+    instr->length = 1;
+    instr->latency = LATENCY_NONE;
+}
@@ -0,0 +1,25 @@
+#ifndef __DISASM_H__
+#define __DISASM_H__
+
+#include <stddef.h>
+
+
+/* Machine instruction decoded for a listing */
+struct disasm
+{
+    size_t      length;     // number of bytes the instruction takes
+    char        text[80];   // instruction in AT&T syntax
+    int         latency;    // rough latency in cycles, assuming memory accesses hit the L1 cache
+};
+
+
+/* Decode the instruction at the given offset into the code
+ *
+ * Only the instructions the compiler generates are known. Anything else is
+ * listed as a single .byte, so the listing always makes progress. Branch
+ * targets, and what RIP-relative operands refer to, are shown as offsets
+ * from the start of the code.
+ */
+void disassemble(const unsigned char* code, size_t size, size_t offset, struct disasm* instr);
+
+#endif
@@ -0,0 +1,130 @@
+#include <string.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "buffer.h"
+#include "layout.h"
+#include "elf.h"
+
+
+/* ELF64 structures as described by the System V ABI
+ *
+ * They are declared here rather than taken from <elf.h>, so that
+ * ELF executables can be produced on hosts that lack that header.
+ */
+struct elf_header
+{
+    unsigned char   e_ident[16];
+    uint16_t        e_type;
+    uint16_t        e_machine;
+    uint32_t        e_version;
+    uint64_t        e_entry;
+    uint64_t        e_phoff;
+    uint64_t        e_shoff;
+    uint32_t        e_flags;
+    uint16_t        e_ehsize;
+    uint16_t        e_phentsize;
+    uint16_t        e_phnum;
+    uint16_t        e_shentsize;
+    uint16_t        e_shnum;
+    uint16_t        e_shstrndx;
+};
+
+
+struct program_header
+{
+    uint32_t        p_type;
+    uint32_t        p_flags;
+    uint64_t        p_offset;
+    uint64_t        p_vaddr;
+    uint64_t        p_paddr;
+    uint64_t        p_filesz;
+    uint64_t        p_memsz;
+    uint64_t        p_align;
+};
+
+
+#define ET_EXEC         2
+#define EM_X86_64       62
+#define EV_CURRENT      1
+#define PT_LOAD         1
+#define PF_X            1
+#define PF_W            2
+#define PF_R            4
+
+
+static void init_header(struct elf_header* header, uint16_t phnum)
+{
+    memset(header, 0, sizeof(struct elf_header));
+
+    memcpy(header->e_ident, "\x7f" "ELF", 4);
+    header->e_ident[4] = 2; // ELFCLASS64
+    header->e_ident[5] = 1; // ELFDATA2LSB
+    header->e_ident[6] = EV_CURRENT;
+    header->e_ident[7] = 0; // ELFOSABI_SYSV
+
+    header->e_type = ET_EXEC;
+    header->e_machine = EM_X86_64;
+    header->e_version = EV_CURRENT;
+    header->e_phoff = sizeof(struct elf_header);
+    header->e_ehsize = sizeof(struct elf_header);
+    header->e_phentsize = sizeof(struct program_header);
+    header->e_phnum = phnum;
+}
+
+
+static void init_segment(struct program_header* segment, uint32_t flags, uint64_t vaddr, size_t page_size)
+{
+    memset(segment, 0, sizeof(struct program_header));
+
+    segment->p_type = PT_LOAD;
+    segment->p_flags = flags;
+    segment->p_vaddr = vaddr;
+    segment->p_paddr = vaddr;
+    segment->p_align = page_size;
+}
+
+
+int write_elf_executable(int fd, const struct buffer* code, size_t page_size, uint64_t data_addr, uint64_t text_addr)
+{
+    struct elf_header header;
+    struct program_header segments[2];
+    size_t headers_size = sizeof(header) + sizeof(segments);
+    size_t code_size = code->size;
+    struct iovec image[3];
+
+    init_header(&header, 2);
+
+    // Runtime state is not backed by the file, so the kernel zero-fills it
+    init_segment(&segments[0], PF_R | PF_W, data_addr, page_size);
+    segments[0].p_offset = 0;
+    segments[0].p_filesz = 0;
+    segments[0].p_memsz = RUNTIME_SIZE;
+
+    // The tape has no segment: the program maps it itself, as the kernel would reserve memory for
+    // all of it, and the guard regions on either side of it are simply left unmapped
+
+    // Text segment maps the file from the beginning, headers included, 
+    // so that file offset and virtual address are congruent modulo page size
+    init_segment(&segments[1], PF_R | PF_X, text_addr, page_size);
+    segments[1].p_offset = 0;
+    segments[1].p_filesz = headers_size + code_size;
+    segments[1].p_memsz = headers_size + code_size;
+
+    // There is no interpreter, the kernel jumps straight to the code
+    header.e_entry = text_addr + headers_size;
+
+    // Write the whole image with a single system call
+    image[0].iov_base = &header;
+    image[0].iov_len = sizeof(header);
+    image[1].iov_base = segments;
+    image[1].iov_len = sizeof(segments);
+    image[2].iov_base = code->data;
+    image[2].iov_len = code_size;
+
+    if (writev(fd, image, 3) != (ssize_t) (headers_size + code_size))
+    {
+        return -1;
+    }
+
+    return 0;
+}
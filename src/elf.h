@@ -0,0 +1,9 @@
+#ifndef __ELF_H__
+#define __ELF_H__
+
+#include <stdint.h>
+#include "buffer.h"
+
+int write_elf_executable(int fd, const struct buffer* code, size_t page_size, uint64_t data_addr, uint64_t text_addr);
+
+#endif
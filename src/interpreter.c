@@ -0,0 +1,189 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "ir.h"
+#include "layout.h"
+#include "compiler.h"
+#include "interpreter.h"
+
+
+/* Handlers beyond the ones for the plain opcodes */
+enum handler
+{
+    HANDLER_MOVE_LOOP_END = OP_SCAN + 1,    // pointer move followed by a loop end, as in [->>+<<]
+    HANDLER_SCAN_RIGHT,                     // [>] over byte cells, done with memchr
+    HANDLER_END,                            // end of the program
+    HANDLERS
+};
+
+
+/* Instruction of the threaded code
+ *
+ * Every instruction carries the address of the code that runs it, so
+ * dispatching is a single indirect jump. Instruction i of the program is
+ * thread operation i, which keeps loop targets the same.
+ */
+struct thread_op
+{
+    const void*     handler;    // label of the code running the operation
+    int32_t         count;      // value to add or store, factor, or distance to move
+    int32_t         offset;     // cell the operation applies to
+    int32_t         source;     // cell a multiplication reads, or thread operation a loop jumps to
+};
+
+
+/* Translate the program to threaded code, fusing common instruction pairs */
+static struct thread_op* build_thread(const struct program* program, const void* const* handlers, int cell_bits)
+{
+    struct thread_op* ops = (struct thread_op*) malloc((program->length + 1) * sizeof(struct thread_op));
+    if (ops == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return NULL;
+    }
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        const struct instr* instr = &program->instrs[index];
+        struct thread_op* op = &ops[index];
+
+        op->handler = handlers[instr->opcode];
+        op->count = instr->count;
+        op->offset = instr->offset;
+        op->source = instr->source;
+
+        switch (instr->opcode)
+        {
+            case OP_LOOP_BEGIN:
+                op->source = instr->match + 1;
+                break;
+
+            case OP_LOOP_END:
+                op->source = instr->match + 1;
+                break;
+
+            case OP_MOVE:
+                // Nothing jumps to a loop end, so it can be run as part of the move
+                if (index + 1 < program->length && program->instrs[index + 1].opcode == OP_LOOP_END)
+                {
+                    op->handler = handlers[HANDLER_MOVE_LOOP_END];
+                    op->source = program->instrs[index + 1].match + 1;
+                }
+                break;
+
+            case OP_SCAN:
+                if (cell_bits == 8 && instr->count == 1)
+                {
+                    op->handler = handlers[HANDLER_SCAN_RIGHT];
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    ops[program->length].handler = handlers[HANDLER_END];
+    return ops;
+}
+
+
+/* Jump to the thread operation n operations ahead */
+#define DISPATCH(n) do { op += (n); goto *op->handler; } while (0)
+
+
+/* Jump to thread operation target */
+#define JUMP(target) do { op = ops + (target); goto *op->handler; } while (0)
+
+
+/* Computed goto is a GNU extension that both GCC and clang support */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+#define CELL        uint8_t
+#define INTERPRET   interpret_8
+#include "interpreter_loop.h"
+#undef CELL
+#undef INTERPRET
+
+#define CELL        uint16_t
+#define INTERPRET   interpret_16
+#include "interpreter_loop.h"
+#undef CELL
+#undef INTERPRET
+
+#define CELL        uint32_t
+#define INTERPRET   interpret_32
+#include "interpreter_loop.h"
+#undef CELL
+#undef INTERPRET
+
+#define CELL        uint64_t
+#define INTERPRET   interpret_64
+#include "interpreter_loop.h"
+#undef CELL
+#undef INTERPRET
+
+#pragma GCC diagnostic pop
+
+
+int interpret_program(const struct program* program, const struct options* options)
+{
+    size_t reserved = GUARD_SIZE + options->tape_size + GUARD_SIZE;
+    unsigned char* tape;
+    int status;
+
+    // Tape sits between guard regions, just like it does for compiled code
+    unsigned char* memory = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to allocate tape\n");
+        return -ENOMEM;
+    }
+
+    tape = memory + GUARD_SIZE;
+    if (mprotect(tape, options->tape_size, PROT_READ | PROT_WRITE) != 0)
+    {
+        munmap(memory, reserved);
+        fprintf(stderr, "Failed to allocate tape\n");
+        return -ENOMEM;
+    }
+
+    if (!options->buffered_output)
+    {
+        setvbuf(stdout, NULL, _IONBF, 0);
+    }
+
+    if (!options->buffered_input)
+    {
+        setvbuf(stdin, NULL, _IONBF, 0);
+    }
+
+    switch (options->cell_bits)
+    {
+        case 16:
+            status = interpret_16(program, options, tape, options->tape_size);
+            break;
+
+        case 32:
+            status = interpret_32(program, options, tape, options->tape_size);
+            break;
+
+        case 64:
+            status = interpret_64(program, options, tape, options->tape_size);
+            break;
+
+        default:
+            status = interpret_8(program, options, tape, options->tape_size);
+            break;
+    }
+
+    fflush(stdout);
+    munmap(memory, reserved);
+
+    return status;
+}
@@ -0,0 +1,16 @@
+#ifndef __INTERPRETER_H__
+#define __INTERPRETER_H__
+
+#include "ir.h"
+#include "compiler.h"
+
+
+/* Run the program with the threaded interpreter, without generating any code
+ *
+ * Honours the cell width, tape size, EOF behaviour and output buffering
+ * of the options. Returns the program's exit status (the value of the
+ * current cell when it terminates), or a negative errno on failure.
+ */
+int interpret_program(const struct program* program, const struct options* options);
+
+#endif
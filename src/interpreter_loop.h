@@ -0,0 +1,118 @@
+/* Threaded interpreter for one cell width
+ *
+ * interpreter.c includes this once for every cell width, with CELL defined
+ * as the cell type and INTERPRET as the name of the function, which is why
+ * there is no include guard.
+ */
+static int INTERPRET(const struct program* program, const struct options* options, unsigned char* tape, size_t tape_size)
+{
+    static const void* const handlers[HANDLERS] =
+    {
+        [OP_ADD] = &&op_add,
+        [OP_MOVE] = &&op_move,
+        [OP_LOOP_BEGIN] = &&op_loop_begin,
+        [OP_LOOP_END] = &&op_loop_end,
+        [OP_WRITE] = &&op_write,
+        [OP_READ] = &&op_read,
+        [OP_SET] = &&op_set,
+        [OP_MUL] = &&op_mul,
+        [OP_SCAN] = &&op_scan,
+        [HANDLER_MOVE_LOOP_END] = &&op_move_loop_end,
+        [HANDLER_SCAN_RIGHT] = &&op_scan_right,
+        [HANDLER_END] = &&op_end
+    };
+
+    CELL eof_cell = options->eof == EOF_MINUS_ONE ? (CELL) -1 : 0;
+    unsigned char* tape_end = tape + tape_size;
+    CELL* cell = (CELL*) tape;
+    struct thread_op* ops;
+    struct thread_op* op;
+    int byte;
+
+    ops = build_thread(program, handlers, options->cell_bits);
+    if (ops == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    op = ops;
+    goto *op->handler;
+
+op_add:
+    cell[op->offset] += (CELL) op->count;
+    DISPATCH(1);
+
+op_set:
+    cell[op->offset] = (CELL) op->count;
+    DISPATCH(1);
+
+op_mul:
+    // Counts are sign-extended to the cell width, the product wraps around like the cells do
+    cell[op->offset] += (CELL) ((uint64_t) cell[op->source] * (uint64_t) (int64_t) op->count);
+    DISPATCH(1);
+
+op_move:
+    cell += op->count;
+    DISPATCH(1);
+
+op_move_loop_end:
+    cell += op->count;
+    if (*cell != 0)
+    {
+        JUMP(op->source);
+    }
+    DISPATCH(2);
+
+op_loop_begin:
+    if (*cell == 0)
+    {
+        JUMP(op->source);
+    }
+    DISPATCH(1);
+
+op_loop_end:
+    if (*cell != 0)
+    {
+        JUMP(op->source);
+    }
+    DISPATCH(1);
+
+op_scan:
+    while (*cell != 0)
+    {
+        cell += op->count;
+    }
+    DISPATCH(1);
+
+op_scan_right:
+    // Running off the tape leaves the pointer on the guard region, so the next access faults
+    cell = memchr(cell, 0, tape_end - (unsigned char*) cell);
+    if (cell == NULL)
+    {
+        cell = (CELL*) tape_end;
+    }
+    DISPATCH(1);
+
+op_write:
+    putchar((unsigned char) cell[op->offset]);
+    DISPATCH(1);
+
+op_read:
+    // Make sure prompts are visible before blocking on input
+    fflush(stdout);
+
+    byte = getchar();
+    if (byte != EOF)
+    {
+        cell[op->offset] = (CELL) byte;
+    }
+    else if (options->eof != EOF_NO_CHANGE)
+    {
+        cell[op->offset] = eof_cell;
+    }
+    DISPATCH(1);
+
+op_end:
+    free(ops);
+    return (uint8_t) *cell;
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "ir.h"
+
+
+int program_init(struct program* program, size_t capacity)
+{
+    program->length = 0;
+    program->capacity = capacity > 0 ? capacity : 1;
+    program->instrs = (struct instr*) malloc(program->capacity * sizeof(struct instr));
+
+    if (program->instrs == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+
+struct instr* program_append(struct program* program, enum opcode opcode)
+{
+    if (program->length == program->capacity)
+    {
+        size_t capacity = program->capacity * 2;
+        struct instr* instrs = (struct instr*) realloc(program->instrs, capacity * sizeof(struct instr));
+
+        if (instrs == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return NULL;
+        }
+
+        program->instrs = instrs;
+        program->capacity = capacity;
+    }
+
+    struct instr* instr = &program->instrs[program->length++];
+    memset(instr, 0, sizeof(struct instr));
+    instr->opcode = opcode;
+
+    return instr;
+}
+
+
+void program_free(struct program* program)
+{
+    free(program->instrs);
+    program->instrs = NULL;
+    program->length = 0;
+    program->capacity = 0;
+}
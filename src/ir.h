@@ -0,0 +1,71 @@
+#ifndef __IR_H__
+#define __IR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Operations of the intermediate representation */
+enum opcode
+{
+    OP_ADD,             // add count to the cell at offset
+    OP_MOVE,            // move the cell pointer count cells
+    OP_LOOP_BEGIN,      // skip past the matching OP_LOOP_END if the current cell is zero
+    OP_LOOP_END,        // jump back to the matching OP_LOOP_BEGIN
+    OP_WRITE,           // print the value of the cell at offset to stdout
+    OP_READ,            // read the value of the cell at offset from stdin
+    OP_SET,             // set the cell at offset to count
+    OP_MUL,             // add count times the cell at source to the cell at offset
+    OP_SCAN             // move the cell pointer count cells at a time until the current cell is zero
+};
+
+
+/* Largest distance in cells an instruction may reach from the cell pointer
+ *
+ * Even with 64-bit cells, such a cell is in reach of a 32-bit displacement.
+ */
+#define MAX_OFFSET      (INT32_MAX / 8)
+
+
+/* Instruction of the intermediate representation
+ *
+ * Runs of '+' and '-' (and of '<' and '>') are folded into one instruction
+ * whose count is the net sum of the run. Instructions are stored back to back 
+ * in one array and refer to each other by index, so there are no pointers to
+ * chase.
+ */
+struct instr
+{
+    uint8_t     opcode;     // which operation this is
+    int32_t     count;      // value to add, or number of cells to move
+    int32_t     offset;     // cell the operation applies to, relative to the cell pointer
+    union
+    {
+        uint32_t    match;  // index of the matching loop instruction
+        int32_t     source; // cell the operand is read from, relative to the cell pointer
+    };
+    uint32_t    position;   // byte offset in the source of the command the instruction came from
+};
+
+
+/* A program is a growable array of instructions */
+struct program
+{
+    struct instr*   instrs;     // instructions, in program order
+    size_t          length;     // number of instructions in use
+    size_t          capacity;   // number of instructions allocated
+};
+
+
+/* Allocate room for a program of the given initial capacity */
+int program_init(struct program* program, size_t capacity);
+
+
+/* Append an instruction to the program, growing it if necessary */
+struct instr* program_append(struct program* program, enum opcode opcode);
+
+
+/* Release the memory held by the program */
+void program_free(struct program* program);
+
+#endif
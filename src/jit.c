@@ -0,0 +1,105 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "buffer.h"
+#include "ir.h"
+#include "target.h"
+#include "compiler.h"
+#include "passes.h"
+#include "jit.h"
+
+
+/* Copy the code into a fresh mapping and make it executable */
+static void* map_code(const struct buffer* buffer, size_t page_size, size_t* length)
+{
+    *length = (buffer->size + page_size - 1) & ~(page_size - 1);
+
+    unsigned char* code = mmap(NULL, *length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (code == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    memcpy(code, buffer->data, buffer->size);
+
+    if (mprotect(code, *length, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(code, *length);
+        return NULL;
+    }
+
+    return code;
+}
+
+
+int run_program(const struct program* program, size_t page_size, const struct target* target, const struct options* options, struct stats* stats)
+{
+    size_t data_size = DATA_SIZE(options->tape_size);
+    struct buffer buffer;
+    struct target jit_target = *target;
+    void* code;
+    size_t code_length;
+    int (*entry)(void);
+    uint64_t start;
+    int status;
+
+    // Generated code returns to us instead of terminating the process, and uses the tape mapped here
+    jit_target.exit_syscall = 0;
+    jit_target.map_tape = 0;
+
+    // Reserve address space for runtime state, tape and guard regions without committing
+    // any memory, then open up the parts that should be accessible; the kernel zero-fills
+    // pages when they are first touched, just like the executable's data segment
+    unsigned char* data = mmap(NULL, data_size, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to allocate tape\n");
+        return -ENOMEM;
+    }
+
+    if (mprotect(data, RUNTIME_SIZE, PROT_READ | PROT_WRITE) != 0
+            || mprotect(data + TAPE_OFFSET, options->tape_size, PROT_READ | PROT_WRITE) != 0)
+    {
+        munmap(data, data_size);
+        fprintf(stderr, "Failed to allocate tape\n");
+        return -ENOMEM;
+    }
+
+    start = stats_clock();
+    status = compile(program, &buffer, (uint64_t) (uintptr_t) data, &jit_target, options, NULL);
+    if (stats != NULL)
+    {
+        stats->codegen = 1;
+        stats->codegen_time = stats_clock() - start;
+        stats->code_size = buffer.size;
+    }
+
+    if (status < 0)
+    {
+        buffer_free(&buffer);
+        munmap(data, data_size);
+        fprintf(stderr, "Failed to compile to byte code\n");
+        return status;
+    }
+
+    code = map_code(&buffer, page_size, &code_length);
+    buffer_free(&buffer);
+    if (code == NULL)
+    {
+        munmap(data, data_size);
+        fprintf(stderr, "Failed to map executable memory\n");
+        return -errno;
+    }
+
+    // Object to function pointer conversion is not ISO C, but POSIX guarantees it works
+    *((void**) &entry) = code;
+    status = entry() & 0xff;
+
+    munmap(code, code_length);
+    munmap(data, data_size);
+
+    return status;
+}
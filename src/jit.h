@@ -0,0 +1,19 @@
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include <stdint.h>
+#include "ir.h"
+#include "target.h"
+#include "compiler.h"
+#include "passes.h"
+
+
+/* Compile the program into executable memory and run it in this process
+ *
+ * Returns the program's exit status (the value of the current cell
+ * when it terminates), or a negative errno on failure. Code generation
+ * is recorded in stats when it is not NULL.
+ */
+int run_program(const struct program* program, size_t page_size, const struct target* target, const struct options* options, struct stats* stats);
+
+#endif
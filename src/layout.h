@@ -0,0 +1,33 @@
+#ifndef __LAYOUT_H__
+#define __LAYOUT_H__
+
+#include <stdint.h>
+
+
+/* Layout of the data segment, relative to the data address
+ *
+ * The runtime state comes first. The tape follows, with an inaccessible
+ * guard region on either side of it, so that a cell pointer that runs off
+ * the tape faults in hardware instead of silently corrupting memory.
+ */
+#define OUTPUT_BUFFER   0x0000                          // buffered output
+#define OUTPUT_SIZE     0x1000
+#define OUTPUT_COUNT    (OUTPUT_BUFFER + OUTPUT_SIZE)   // number of bytes in the output buffer (32-bit)
+#define INPUT_POS       (OUTPUT_COUNT + 0x08)           // address of the next input byte (64-bit)
+#define INPUT_END       (OUTPUT_COUNT + 0x10)           // address past the last input byte (64-bit)
+#define SCAN_AVX2       (OUTPUT_COUNT + 0x18)           // scans can use AVX2 (8-bit)
+#define INPUT_BUFFER    (OUTPUT_BUFFER + 0x2000)        // buffered input
+#define INPUT_SIZE      0x4000
+#define PROFILE_PATH    (INPUT_BUFFER + INPUT_SIZE)     // file instrumented programs write their profile to
+#define PROFILE_PATH_SIZE 0x1000
+#define PROFILE         0x10000                         // profile header and loop counters of instrumented programs
+#define RUNTIME_SIZE    0x100000                        // runtime state, in whole pages
+
+#define GUARD_SIZE      0x80000000ULL                   // out of reach of any 32-bit cell offset
+#define TAPE_OFFSET     (RUNTIME_SIZE + GUARD_SIZE)     // first cell
+#define TAPE_SIZE       0x10000                         // default number of cells
+#define MAX_TAPE_SIZE   (1ULL << 40)
+
+#define DATA_SIZE(tape_size)    (TAPE_OFFSET + (uint64_t) (tape_size) + GUARD_SIZE)
+
+#endif
@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "buffer.h"
+#include "ir.h"
+#include "disasm.h"
+#include "profile.h"
+#include "listing.h"
+
+
+int source_map_init(struct source_map* map, const char* path)
+{
+    size_t capacity = 1024;
+    unsigned char chunk[1 << 16];
+    uint32_t offset = 0;
+    size_t bytes;
+    FILE* stream;
+
+    map->count = 1;
+    map->lines = (uint32_t*) malloc(capacity * sizeof(uint32_t));
+    if (map->lines == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+    map->lines[0] = 0;
+
+    if ((stream = fopen(path, "r")) == NULL)
+    {
+        fprintf(stderr, "Could not open file for read: %s\n", path);
+        return -errno;
+    }
+
+    while ((bytes = fread(chunk, 1, sizeof(chunk), stream)) > 0)
+    {
+        for (size_t byte = 0; byte < bytes; ++byte)
+        {
+            if (chunk[byte] != '\n')
+            {
+                continue;
+            }
+
+            if (map->count == capacity)
+            {
+                uint32_t* lines = (uint32_t*) realloc(map->lines, capacity * 2 * sizeof(uint32_t));
+                if (lines == NULL)
+                {
+                    fclose(stream);
+                    fprintf(stderr, "Out of memory\n");
+                    return -ENOMEM;
+                }
+
+                map->lines = lines;
+                capacity *= 2;
+            }
+
+            map->lines[map->count++] = offset + (uint32_t) byte + 1;
+        }
+
+        offset += (uint32_t) bytes;
+    }
+
+    fclose(stream);
+    return 0;
+}
+
+
+void source_map_free(struct source_map* map)
+{
+    free(map->lines);
+    map->lines = NULL;
+    map->count = 0;
+}
+
+
+/* Format a source position as line:column */
+static void format_position(char* text, size_t capacity, const struct source_map* map, uint32_t position)
+{
+    size_t low = 0;
+    size_t high = map->count;
+
+    // Last line starting at or before the position
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (map->lines[middle] <= position)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    snprintf(text, capacity, "%zu:%u", low + 1, position - map->lines[low] + 1);
+}
+
+
+/* Format an instruction of the optimised program */
+static void format_instr(char* text, size_t capacity, const struct instr* instr)
+{
+    switch (instr->opcode)
+    {
+        case OP_ADD:
+            snprintf(text, capacity, "add     cell[%d] %s= %lld", instr->offset, instr->count < 0 ? "-" : "+",
+                    instr->count < 0 ? -(long long) instr->count : (long long) instr->count);
+            break;
+
+        case OP_MOVE:
+            snprintf(text, capacity, "move    %+d", instr->count);
+            break;
+
+        case OP_LOOP_BEGIN:
+            snprintf(text, capacity, "loop    until cell[0] = 0, ends at %u", instr->match);
+            break;
+
+        case OP_LOOP_END:
+            snprintf(text, capacity, "end     of loop at %u", instr->match);
+            break;
+
+        case OP_WRITE:
+            snprintf(text, capacity, "write   cell[%d]", instr->offset);
+            break;
+
+        case OP_READ:
+            snprintf(text, capacity, "read    cell[%d]", instr->offset);
+            break;
+
+        case OP_SET:
+            snprintf(text, capacity, "set     cell[%d] = %d", instr->offset, instr->count);
+            break;
+
+        case OP_MUL:
+            snprintf(text, capacity, "mul     cell[%d] += cell[%d] * %d", instr->offset, instr->source, instr->count);
+            break;
+
+        case OP_SCAN:
+            snprintf(text, capacity, "scan    %+d until cell[0] = 0", instr->count);
+            break;
+
+        default:
+            snprintf(text, capacity, "opcode  %u", instr->opcode);
+            break;
+    }
+}
+
+
+void print_tokens(FILE* stream, const struct program* program, const struct source_map* map)
+{
+    static const char commands[] = { [OP_LOOP_BEGIN] = '[', [OP_LOOP_END] = ']', [OP_WRITE] = '.', [OP_READ] = ',' };
+    char position[32];
+
+    fprintf(stream, "; index   source    command\n");
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        const struct instr* instr = &program->instrs[index];
+
+        format_position(position, sizeof(position), map, instr->position);
+        fprintf(stream, "%7zu   %-9s ", index, position);
+
+        // Runs are shown as the command and how many times it was repeated
+        switch (instr->opcode)
+        {
+            case OP_ADD:
+                fprintf(stream, "%c%lld\n", instr->count < 0 ? '-' : '+', instr->count < 0 ? -(long long) instr->count : (long long) instr->count);
+                break;
+
+            case OP_MOVE:
+                fprintf(stream, "%c%lld\n", instr->count < 0 ? '<' : '>', instr->count < 0 ? -(long long) instr->count : (long long) instr->count);
+                break;
+
+            default:
+                fprintf(stream, "%c\n", commands[instr->opcode]);
+                break;
+        }
+    }
+}
+
+
+void print_ir(FILE* stream, const struct program* program, const struct source_map* map, const struct profile* profile)
+{
+    char position[32];
+    char text[96];
+    int depth = 0;
+
+    fprintf(stream, "; index   source    instruction\n");
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        const struct instr* instr = &program->instrs[index];
+
+        depth -= instr->opcode == OP_LOOP_END;
+
+        format_position(position, sizeof(position), map, instr->position);
+        format_instr(text, sizeof(text), instr);
+        fprintf(stream, "%7zu   %-9s %*s%s", index, position, 2 * depth, "", text);
+
+        if (profile != NULL && instr->opcode == OP_LOOP_BEGIN)
+        {
+            const struct loop_profile* counters = profile_find(profile, instr->position);
+            if (counters != NULL)
+            {
+                fprintf(stream, ", entered %llu times, %llu iterations", (unsigned long long) counters->entries, (unsigned long long) counters->iterations);
+            }
+        }
+
+        fputc('\n', stream);
+
+        depth += instr->opcode == OP_LOOP_BEGIN;
+    }
+}
+
+
+void print_asm(FILE* stream, const struct program* program, const struct buffer* code, const uint32_t* addresses, const struct source_map* map)
+{
+    char position[32] = "-";
+    char text[96];
+    char bytes[48];
+    size_t index = 0;
+    size_t offset = 0;
+    int epilogue = 0;
+
+    fprintf(stream, "; offset  bytes                          instruction                                   source    latency\n");
+
+    if (program->length == 0 || addresses[0] > 0)
+    {
+        fprintf(stream, "\n; prologue and runtime routines\n");
+    }
+
+    while (offset < addresses[program->length + 1])
+    {
+        struct disasm instr;
+
+        // Header for every instruction of the program whose code starts here
+        while (index < program->length && addresses[index] <= offset)
+        {
+            format_position(position, sizeof(position), map, program->instrs[index].position);
+            format_instr(text, sizeof(text), &program->instrs[index]);
+            fprintf(stream, "\n; %zu  %s  %s%s\n", index, position, text, addresses[index + 1] == addresses[index] ? "  (no code)" : "");
+            ++index;
+        }
+
+        if (!epilogue && index == program->length && offset >= addresses[program->length])
+        {
+            fprintf(stream, "\n; epilogue\n");
+            snprintf(position, sizeof(position), "-");
+            epilogue = 1;
+        }
+
+        disassemble(code->data, code->size, offset, &instr);
+
+        bytes[0] = '\0';
+        for (size_t byte = 0; byte < instr.length && byte < 10; ++byte)
+        {
+            snprintf(bytes + 3 * byte, sizeof(bytes) - 3 * byte, "%02x ", code->data[offset + byte]);
+        }
+
+        fprintf(stream, "%08zx  %-30s %-45s %-9s %4d\n", offset, bytes, instr.text, position, instr.latency);
+        offset += instr.length;
+    }
+
+    // Constants are data, shown 8 bytes at a time
+    if (offset < code->size)
+    {
+        fprintf(stream, "\n; constants\n");
+    }
+
+    while (offset < code->size)
+    {
+        uint64_t value = 0;
+
+        bytes[0] = '\0';
+        for (size_t byte = 0; byte < 8 && offset + byte < code->size; ++byte)
+        {
+            snprintf(bytes + 3 * byte, sizeof(bytes) - 3 * byte, "%02x ", code->data[offset + byte]);
+            value |= (uint64_t) code->data[offset + byte] << (8 * byte);
+        }
+
+        snprintf(text, sizeof(text), "%-10s0x%016llx", ".quad", (unsigned long long) value);
+        fprintf(stream, "%08zx  %-30s %s\n", offset, bytes, text);
+        offset += 8;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __LISTING_H__
+#define __LISTING_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "buffer.h"
+#include "ir.h"
+#include "profile.h"
+
+
+/* Stages whose output --emit prints instead of producing an executable */
+enum emit_stage
+{
+    EMIT_NONE,          // compile as usual
+    EMIT_TOKENS,        // commands as they were read, with runs folded
+    EMIT_IR,            // instructions after optimisation
+    EMIT_ASM            // generated machine code
+};
+
+
+/* Where the lines of the source start, to turn byte positions into line and column */
+struct source_map
+{
+    uint32_t*   lines;      // byte offset of the first character of every line
+    size_t      count;      // number of lines
+};
+
+
+/* Read the source file again and find where its lines start */
+int source_map_init(struct source_map* map, const char* path);
+
+
+/* Release the memory held by the source map */
+void source_map_free(struct source_map* map);
+
+
+/* Print the program as it came out of the tokenizer */
+void print_tokens(FILE* stream, const struct program* program, const struct source_map* map);
+
+
+/* Print the program, with loop bodies indented
+ *
+ * With a profile, loops show how often they were entered and how many
+ * iterations they ran.
+ */
+void print_ir(FILE* stream, const struct program* program, const struct source_map* map, const struct profile* profile);
+
+
+/* Print the generated code as assembly
+ *
+ * Every machine instruction is annotated with the source position of the
+ * instruction it was generated for, found through the addresses compile()
+ * reported, and with its estimated latency. The constants after the code
+ * are shown as data.
+ */
+void print_asm(FILE* stream, const struct program* program, const struct buffer* code, const uint32_t* addresses, const struct source_map* map);
+
+#endif
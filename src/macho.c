@@ -3,7 +3,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
-#include "page.h"
+#include <sys/uio.h>
+#include "buffer.h"
+#include "layout.h"
 #include "macho.h"
 
 
@@ -98,34 +100,6 @@ static struct segment_command_64* create_segment(struct mach_header_64* mh, cons
 }
 
 
-static size_t count_pages(struct page* page_list)
-{
-    size_t pages = 0;
-
-    while (page_list != NULL)
-    {
-        page_list = page_list->next;
-        ++pages;
-    }
-
-    return pages;
-}
-
-
-static size_t count_size(struct page* page_list)
-{
-    size_t size = 0;
-
-    while (page_list != NULL)
-    {
-        size += page_list->size;
-        page_list = page_list->next;
-    }
-
-    return size;
-}
-
-
 static size_t count_load_commands(struct mach_header_64* header, uint32_t ncmds, ...)
 {
     // TODO: use this function instead of passing mh around 
@@ -204,31 +178,74 @@ static struct dylib_command* create_dylib(struct mach_header_64* mh)
 }
 
 
-static size_t write_load_command(const void* load_command, FILE* stream)
+static void add_load_command(struct iovec* image, const void* load_command)
 {
-    return fwrite(load_command, ((const struct load_command*) load_command)->cmdsize, 1, stream);
+    image->iov_base = (void*) load_command;
+    image->iov_len = ((const struct load_command*) load_command)->cmdsize;
 }
 
 
-int write_executable(FILE* output_file, struct page* page_list, size_t page_size, uint64_t data_addr, uint64_t text_addr)
+int write_macho_executable(int fd, const struct buffer* code, size_t page_size, uint64_t data_addr, uint64_t text_addr)
 {
-    // TODO: handle errors
+    uint32_t pages = (code->size + page_size - 1) / page_size;
+    uint32_t code_size = code->size;
+    struct iovec image[15];
+    size_t image_size = 0;
+    ssize_t written;
+
+    struct segment_command_64* null_segment = NULL;
+    struct segment_command_64* data_segment = NULL;
+    struct segment_command_64* low_guard = NULL;
+    struct segment_command_64* high_guard = NULL;
+    struct segment_command_64* text_segment = NULL;
+    struct segment_command_64* linkedit = NULL;
+    struct dyld_info_command* dyldinfo = NULL;
+    struct dylinker_command* dyld = NULL;
+    struct dylib_command* dylib = NULL;
+
+    // Create Mach-O header and the load commands that need memory, in the order they are written
+    struct mach_header_64* header = create_header();
+    if (header != NULL)
+    {
+        null_segment = create_segment(header, SEG_PAGEZERO, NULL);
+        data_segment = create_segment(header, SEG_DATA, SECT_DATA);
+        low_guard = create_segment(header, "__GUARD_LOW", NULL);
+        high_guard = create_segment(header, "__GUARD_HIGH", NULL);
+        text_segment = create_segment(header, SEG_TEXT, SECT_TEXT);
+        linkedit = create_segment(header, SEG_LINKEDIT, NULL);
+        dyldinfo = create_dyld_info(header);
+        dyld = create_dyld(header);
+        dylib = create_dylib(header);
+    }
 
-    uint32_t pages = count_pages(page_list);
-    uint32_t code_size = count_size(page_list);
+    image[14].iov_len = pages * page_size - code_size;
+    image[14].iov_base = calloc(1, image[14].iov_len + 1);
 
-    // Create Mach-O header
-    struct mach_header_64* header = create_header();
+    if (header == NULL || null_segment == NULL || data_segment == NULL || low_guard == NULL || high_guard == NULL
+            || text_segment == NULL || linkedit == NULL || dyldinfo == NULL || dyld == NULL || dylib == NULL
+            || image[14].iov_base == NULL)
+    {
+        free(image[14].iov_base);
+        free(header);
+        free(null_segment);
+        free(text_segment);
+        free(linkedit);
+        free(data_segment);
+        free(low_guard);
+        free(high_guard);
+        free(dyldinfo);
+        free(dyld);
+        free(dylib);
+        return -1;
+    }
 
-    // Create null segment
-    struct segment_command_64* null_segment = create_segment(header, SEG_PAGEZERO, NULL);
+    // Null segment
     null_segment->vmaddr = 0x0;
     null_segment->vmsize = data_addr;
 
-    // Create data segment
-    struct segment_command_64* data_segment = create_segment(header, SEG_DATA, SECT_DATA);
+    // Data segment for the runtime state
     data_segment->vmaddr = data_addr;
-    data_segment->vmsize = text_addr - data_addr;
+    data_segment->vmsize = RUNTIME_SIZE;
     data_segment->maxprot = VM_PROT_READ | VM_PROT_WRITE;
     data_segment->initprot = VM_PROT_READ | VM_PROT_WRITE;
 
@@ -237,11 +254,16 @@ int write_executable(FILE* output_file, struct page* page_list, size_t page_size
     data_section->size = data_segment->vmsize;
     data_section->flags = S_ZEROFILL;
 
-    // FIXME: We probably want another 4 GB of VM_PROT_NONE data in case cell pointer goes out of bounds
-    //        This will require a rewrite of create_segment
+    // Inaccessible segments around the tape, so that a cell pointer out of bounds faults;
+    // the tape between them has no segment, as the program maps it itself at start-up, like on
+    // Linux, instead of having the loader reserve all of it
+    low_guard->vmaddr = data_addr + RUNTIME_SIZE;
+    low_guard->vmsize = GUARD_SIZE;
+
+    high_guard->vmaddr = text_addr - GUARD_SIZE;
+    high_guard->vmsize = GUARD_SIZE;
 
-    // Create text segment
-    struct segment_command_64* text_segment = create_segment(header, SEG_TEXT, SECT_TEXT);
+    // Text segment
     text_segment->vmaddr = text_addr;
     text_segment->vmsize = pages * page_size; 
     text_segment->fileoff = 0;
@@ -257,16 +279,11 @@ int write_executable(FILE* output_file, struct page* page_list, size_t page_size
     text_section->nreloc = 0;
     text_section->flags = S_ATTR_PURE_INSTRUCTIONS | S_ATTR_SOME_INSTRUCTIONS;
 
-    // Create linkedit segment
-    struct segment_command_64* linkedit = create_segment(header, SEG_LINKEDIT, NULL);
+    // Linkedit segment
     linkedit->fileoff = text_segment->fileoff + text_segment->filesize;
     linkedit->filesize = 0;
 
-    // Create dynamic loader stuff
-    struct dyld_info_command* dyldinfo = create_dyld_info(header);
-    struct dylinker_command* dyld = create_dyld(header);
-    struct dylib_command* dylib = create_dylib(header);
-
+    // Dynamic loader stuff
     struct dysymtab_command dysymtab;
     memset(&dysymtab, 0, sizeof(dysymtab));
     dysymtab.cmd = LC_DYSYMTAB;
@@ -291,35 +308,44 @@ int write_executable(FILE* output_file, struct page* page_list, size_t page_size
     // Set correct offsets
     entry_point.entryoff = text_section->offset = header->sizeofcmds + sizeof(*header);
 
-    // Write headers to file
-    fwrite(header, sizeof(struct mach_header_64), 1, output_file);
-    write_load_command(null_segment, output_file);
-    write_load_command(data_segment, output_file);
-    write_load_command(text_segment, output_file);
-    write_load_command(linkedit, output_file);
-    write_load_command(dyldinfo, output_file);
-    write_load_command(&dysymtab, output_file);
-    write_load_command(dyld, output_file);
-    write_load_command(dylib, output_file);
-    write_load_command(&symtab, output_file);
-    write_load_command(&entry_point, output_file);
+    // Write headers, code and padding up to the end of the last page with a single system call
+    image[0].iov_base = header;
+    image[0].iov_len = sizeof(struct mach_header_64);
+    add_load_command(&image[1], null_segment);
+    add_load_command(&image[2], data_segment);
+    add_load_command(&image[3], low_guard);
+    add_load_command(&image[4], high_guard);
+    add_load_command(&image[5], text_segment);
+    add_load_command(&image[6], linkedit);
+    add_load_command(&image[7], dyldinfo);
+    add_load_command(&image[8], &dysymtab);
+    add_load_command(&image[9], dyld);
+    add_load_command(&image[10], dylib);
+    add_load_command(&image[11], &symtab);
+    add_load_command(&image[12], &entry_point);
+    image[13].iov_base = code->data;
+    image[13].iov_len = code_size;
+
+    for (size_t part = 0; part < 15; ++part)
+    {
+        image_size += image[part].iov_len;
+    }
+
+    written = writev(fd, image, 15);
 
     // Free resources
+    free(image[14].iov_base);
     free(header);
     free(null_segment);
     free(text_segment);
     free(linkedit);
     free(data_segment);
+    free(low_guard);
+    free(high_guard);
     free(dyldinfo);
     free(dyld);
     free(dylib);
 
-    // Write code to file
-    while (page_list != NULL)
-    {
-        fwrite(page_list->data, 1, page_size, output_file);
-        page_list = page_list->next;
-    }
-    
-    return 0;
+    // A short write leaves a truncated executable behind
+    return written != (ssize_t) image_size ? -1 : 0;
 }
@@ -1,9 +1,9 @@
 #ifndef __MACHO_H__
 #define __MACHO_H__
 
-#include <stdio.h>
-#include "page.h"
+#include <stdint.h>
+#include "buffer.h"
 
-int write_executable(FILE* output_file, struct page* page_list, size_t page_size, uint64_t data_addr, uint64_t text_addr);
+int write_macho_executable(int fd, const struct buffer* code, size_t page_size, uint64_t data_addr, uint64_t text_addr);
 
 #endif
@@ -3,109 +3,646 @@
 #include <stdint.h>
 #include <errno.h>
 #include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include "parser.h"
 #include "compiler.h"
+#include "passes.h"
+#include "target.h"
+#include "elf.h"
+#include "jit.h"
+#include "interpreter.h"
+#include "listing.h"
+#include "profile.h"
+#ifdef __APPLE__
 #include "macho.h"
+#endif
 
 
-static void free_token_string(struct token* token_string)
+/* File profiles are written to and read from when no other is given */
+#define DEFAULT_PROFILE "bfc.prof"
+
+
+/* Executable formats and the targets they run on */
+struct format
+{
+    const struct target*    target;
+    int (*write_executable)(int, const struct buffer*, size_t, uint64_t, uint64_t);
+};
+
+
+static const struct format formats[] =
 {
-    while (token_string != NULL)
+#ifdef __APPLE__
+    { &target_macos, write_macho_executable },
+#endif
+    { &target_linux, write_elf_executable },
+    { NULL, NULL }
+};
+
+
+static const struct option options[] =
+{
+    { "target", required_argument, NULL, 't' },
+    { "run", no_argument, NULL, 'r' },
+    { "interpret", no_argument, NULL, 'i' },
+    { "unbuffered", no_argument, NULL, 'u' },
+    { "eof", required_argument, NULL, 'e' },
+    { "mmap-input", no_argument, NULL, 'm' },
+    { "no-avx2", no_argument, NULL, 'A' },
+    { "tape-size", required_argument, NULL, 's' },
+    { "cell-bits", required_argument, NULL, 'c' },
+    { "stats", no_argument, NULL, 'S' },
+    { "emit", required_argument, NULL, 'E' },
+    { "instrument", optional_argument, NULL, 'I' },
+    { "profile-use", optional_argument, NULL, 'P' },
+    { "align-loops", required_argument, NULL, 'L' },
+    { "jobs", required_argument, NULL, 'j' },
+    { NULL, 0, NULL, 0 }
+};
+
+
+static const struct format* find_format(const char* name)
+{
+    for (const struct format* format = formats; format->target != NULL; ++format)
     {
-        struct token* next = token_string->next;
-        free(token_string);
-        token_string = next;
+        if (strcmp(format->target->name, name) == 0)
+        {
+            return format;
+        }
     }
+
+    return NULL;
 }
 
 
-static void free_page_list(struct page* page_list)
+static void usage(const char* name)
 {
-    while (page_list != NULL)
+    fprintf(stderr, "Usage: %s [options] [--target=<target>] <source file> <executable>\n", name);
+    fprintf(stderr, "       %s [options] --run <source file>\n", name);
+    fprintf(stderr, "       %s [options] --interpret <source file>\n", name);
+    fprintf(stderr, "       %s [options] [--target=<target>] --emit=<stage> <source file>\n", name);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "  --unbuffered    read and write one byte at a time on every ',' and '.'\n");
+    fprintf(stderr, "  --eof=<value>   cell value on end of file: nochange (default), zero or minus-one\n");
+    fprintf(stderr, "  --mmap-input    read input directly from memory when stdin is a regular file\n");
+    fprintf(stderr, "  --no-avx2       only use SSE2 for scan loops, even if the CPU supports AVX2\n");
+    fprintf(stderr, "  --tape-size=<n> number of cells, optionally with suffix K, M or G (default 64K)\n");
+    fprintf(stderr, "  --cell-bits=<n> cell width: 8 (default), 16, 32 or 64\n");
+    fprintf(stderr, "  --align-loops=<n>\n");
+    fprintf(stderr, "                  start the bodies of hot loops at a multiple of 16 or 32 bytes\n");
+    fprintf(stderr, "  --jobs=<n>      generate code with n threads (default: one per processor)\n");
+    fprintf(stderr, "  -O<level>       optimisation level 0 to %d (default %d), -O3 is the same as -O2 for now\n", MAX_LEVEL, DEFAULT_LEVEL);
+    fprintf(stderr, "  -f[no-]<pass>   run or skip one optimisation pass regardless of the level:\n");
+    for (int pass = 0; pass < PASSES; ++pass)
     {
-        struct page* next = page_list->next;
-        free(page_list);
-        page_list = next;
+        fprintf(stderr, "                    %-16s (from -O%d)\n", passes[pass].name, passes[pass].level);
     }
+    fprintf(stderr, "  --stats         print time spent and sizes of every stage to stderr as JSON\n");
+    fprintf(stderr, "  --emit=<stage>  print tokens, ir (optimised) or asm (annotated listing) to stdout\n");
+    fprintf(stderr, "  --instrument[=<file>]\n");
+    fprintf(stderr, "                  count how often every loop runs, and write that to the file on exit\n");
+    fprintf(stderr, "                  (default %s)\n", DEFAULT_PROFILE);
+    fprintf(stderr, "  --profile-use[=<file>]\n");
+    fprintf(stderr, "                  pick the loops that keep cells in registers, and with\n");
+    fprintf(stderr, "                  --align-loops the loops to align, from the counts of an\n");
+    fprintf(stderr, "                  instrumented run\n");
+}
+
+
+/* Parse a number of cells */
+static int parse_tape_size(const char* arg, uint64_t* cells)
+{
+    char* end;
+    unsigned long long size;
+    int shift = 0;
+
+    errno = 0;
+    size = strtoull(arg, &end, 10);
+    if (errno != 0 || end == arg || *arg == '-')
+    {
+        return -EINVAL;
+    }
+
+    switch (*end)
+    {
+        case 'G': case 'g':
+            shift += 10;
+            // fall through
+        case 'M': case 'm':
+            shift += 10;
+            // fall through
+        case 'K': case 'k':
+            shift += 10;
+            ++end;
+            break;
+    }
+
+    if (*end != '\0' || size == 0 || size > (MAX_TAPE_SIZE >> shift))
+    {
+        return -EINVAL;
+    }
+
+    *cells = size << shift;
+    return 0;
 }
 
 
 int main(int argc, char** argv)
 {
     int status;
-    struct token* token_string = NULL;
-    struct page* page_list = NULL;
+    struct program program;
+    struct buffer code;
     long page_size;
+    int opt;
+    int run = 0;
+    int interpret = 0;
+    int show_stats = 0;
+    enum emit_stage emit = EMIT_NONE;
+    struct source_map map;
+    uint32_t* addresses = NULL;
+    const char* profile_file = NULL;
+    struct profile profile;
+    int level = DEFAULT_LEVEL;
+    unsigned forced_on = 0;
+    unsigned forced_off = 0;
+    struct stats stats;
+    uint64_t start;
+    uint64_t cells = TAPE_SIZE;
+    struct options compile_options = 
+    {
+        .buffered_output = 1,
+        .buffered_input = 1,
+        .mmap_input = 0,
+        .eof = EOF_NO_CHANGE,
+        .avx2 = 1,
+        .cell_bits = 8,
+        .tape_size = 0,
+        .align_loops = 0,
+        .instrument = NULL,
+        .profile = NULL,
+        .jobs = 1,
+        .cell_registers = 1,
+        .rotate_loops = 1,
+        .vector_adds = 1
+    };
+
+    // Default to producing executables for the host
+#ifdef __APPLE__
+    const struct format* host_format = find_format("macos");
+#else
+    const struct format* host_format = find_format("linux");
+#endif
+    const struct format* format = host_format;
+
+    memset(&stats, 0, sizeof(stats));
 
-    // TODO: Rewrite main to support options and stopping at different stages
-    
     page_size = sysconf(_SC_PAGESIZE);
     if (page_size < 0)
     {
         fprintf(stderr, "Failed to get system page size\n");
         return 2;
     }
-    
-    if (argc != 3)
+
+    // Generating code is the only stage that runs in parallel, and it does not change the code
+    compile_options.jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (compile_options.jobs < 1)
     {
-        fprintf(stderr, "Usage: %s <source file> <executable>\n", argv[0]);
+        compile_options.jobs = 1;
+    }
+
+    while ((opt = getopt_long(argc, argv, "t:riue:mAs:c:O::f:SE:I::P::L:j:", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                format = find_format(optarg);
+                if (format == NULL)
+                {
+                    fprintf(stderr, "Unsupported target: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'r':
+                run = 1;
+                break;
+
+            case 'i':
+                interpret = 1;
+                break;
+
+            case 'u':
+                compile_options.buffered_output = 0;
+                compile_options.buffered_input = 0;
+                break;
+
+            case 'e':
+                if (strcmp(optarg, "nochange") == 0)
+                {
+                    compile_options.eof = EOF_NO_CHANGE;
+                }
+                else if (strcmp(optarg, "zero") == 0)
+                {
+                    compile_options.eof = EOF_ZERO;
+                }
+                else if (strcmp(optarg, "minus-one") == 0)
+                {
+                    compile_options.eof = EOF_MINUS_ONE;
+                }
+                else
+                {
+                    fprintf(stderr, "Unsupported EOF behaviour: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'm':
+                compile_options.mmap_input = 1;
+                break;
+
+            case 'A':
+                compile_options.avx2 = 0;
+                break;
+
+            case 's':
+                if (parse_tape_size(optarg, &cells) < 0)
+                {
+                    fprintf(stderr, "Unsupported tape size: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'c':
+                if (strcmp(optarg, "8") != 0 && strcmp(optarg, "16") != 0 && strcmp(optarg, "32") != 0 && strcmp(optarg, "64") != 0)
+                {
+                    fprintf(stderr, "Unsupported cell width: %s\n", optarg);
+                    return 1;
+                }
+                compile_options.cell_bits = atoi(optarg);
+                break;
+
+            case 'L':
+                if (strcmp(optarg, "16") != 0 && strcmp(optarg, "32") != 0)
+                {
+                    fprintf(stderr, "Unsupported loop alignment: %s\n", optarg);
+                    return 1;
+                }
+                compile_options.align_loops = atoi(optarg);
+                break;
+
+            case 'j':
+            {
+                char* end;
+                long jobs = strtol(optarg, &end, 10);
+
+                if (*optarg == '\0' || *end != '\0' || jobs < 1 || jobs > 1024)
+                {
+                    fprintf(stderr, "Unsupported number of jobs: %s\n", optarg);
+                    return 1;
+                }
+                compile_options.jobs = (int) jobs;
+                break;
+            }
+
+            case 'O':
+                // Plain -O is -O1, like it is for C compilers
+                if (optarg == NULL)
+                {
+                    level = 1;
+                }
+                else if (optarg[0] >= '0' && optarg[0] <= '0' + MAX_LEVEL && optarg[1] == '\0')
+                {
+                    level = optarg[0] - '0';
+                }
+                else
+                {
+                    fprintf(stderr, "Unsupported optimisation level: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'f':
+            {
+                int disable = strncmp(optarg, "no-", 3) == 0;
+                int pass = find_pass(optarg + (disable ? 3 : 0));
+                if (pass < 0)
+                {
+                    fprintf(stderr, "Unknown optimisation pass: %s\n", optarg + (disable ? 3 : 0));
+                    return 1;
+                }
+
+                // Last flag for a pass wins
+                if (disable)
+                {
+                    forced_off |= 1U << pass;
+                    forced_on &= ~(1U << pass);
+                }
+                else
+                {
+                    forced_on |= 1U << pass;
+                    forced_off &= ~(1U << pass);
+                }
+                break;
+            }
+
+            case 'S':
+                show_stats = 1;
+                break;
+
+            case 'E':
+                if (strcmp(optarg, "tokens") == 0)
+                {
+                    emit = EMIT_TOKENS;
+                }
+                else if (strcmp(optarg, "ir") == 0)
+                {
+                    emit = EMIT_IR;
+                }
+                else if (strcmp(optarg, "asm") == 0)
+                {
+                    emit = EMIT_ASM;
+                }
+                else
+                {
+                    fprintf(stderr, "Unsupported stage: %s\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'I':
+                compile_options.instrument = optarg != NULL ? optarg : DEFAULT_PROFILE;
+                break;
+
+            case 'P':
+                profile_file = optarg != NULL ? optarg : DEFAULT_PROFILE;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    // Tape holds the given number of cells, rounded up to whole pages
+    if (cells > MAX_TAPE_SIZE / (compile_options.cell_bits / 8))
+    {
+        fprintf(stderr, "Tape is too large, it can be at most %llu bytes\n", (unsigned long long) MAX_TAPE_SIZE);
+        return 1;
+    }
+    compile_options.tape_size = (cells * (compile_options.cell_bits / 8) + page_size - 1) & ~((uint64_t) page_size - 1);
+
+    if (compile_options.mmap_input && !compile_options.buffered_input)
+    {
+        fprintf(stderr, "--mmap-input can not be combined with --unbuffered\n");
         return 1;
     }
 
+    if (run && interpret)
+    {
+        fprintf(stderr, "--run can not be combined with --interpret\n");
+        return 1;
+    }
+
+    if (interpret && compile_options.instrument != NULL)
+    {
+        fprintf(stderr, "--instrument can not be combined with --interpret\n");
+        return 1;
+    }
+
+    if ((run || interpret) && emit != EMIT_NONE)
+    {
+        fprintf(stderr, "--emit can not be combined with --run or --interpret\n");
+        return 1;
+    }
+
+    if (argc - optind != 2 - (run || interpret || emit != EMIT_NONE))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char* source_file = argv[optind];
+    const char* executable_file = argv[optind + 1];
+
     FILE* stream;
+    int fd;
 
-    // Read input file and create token string
-    if ((stream = fopen(argv[1], "r")) == NULL)
+    // Read input file and create program
+    if ((stream = fopen(source_file, "r")) == NULL)
     {
-        fprintf(stderr, "Could not open file for read: %s\n", argv[1]);
+        fprintf(stderr, "Could not open file for read: %s\n", source_file);
         return errno;
     }
 
-    status = tokenize_file(stream, &token_string);
+    start = stats_clock();
+    status = tokenize_file(stream, &program);
     if (status < 0)
     {
         fclose(stream);
+        program_free(&program);
         fprintf(stderr, "Invalid source file\n");
         return -status;
     }
     fclose(stream);
+    stats.tokenize_time = stats_clock() - start;
+    stats.tokens = program.length;
+
+    // Stop at the requested stage, which needs the source again to show line numbers
+    if (emit != EMIT_NONE && (status = source_map_init(&map, source_file)) < 0)
+    {
+        source_map_free(&map);
+        program_free(&program);
+        return -status;
+    }
+
+    if (emit == EMIT_TOKENS)
+    {
+        print_tokens(stdout, &program, &map);
+        source_map_free(&map);
+        program_free(&program);
+        return 0;
+    }
 
-    status = parse(token_string);
+    start = stats_clock();
+    status = parse(&program);
+    stats.parse_time = stats_clock() - start;
     if (status < 0)
     {
+        if (emit != EMIT_NONE)
+        {
+            source_map_free(&map);
+        }
+        program_free(&program);
         fprintf(stderr, "Syntax error\n");
         return -status;
     }
 
-    // Compile tokens to bytecode
-    status = compile(token_string, &page_list, page_size, DATA_ADDR);
+    // Flags for single passes take precedence over the level
+    stats.level = level;
+    status = run_passes(&program, (passes_for_level(level) | forced_on) & ~forced_off, &compile_options, &stats);
+    if (status < 0)
+    {
+        if (emit != EMIT_NONE)
+        {
+            source_map_free(&map);
+        }
+        program_free(&program);
+        return -status;
+    }
+
+    // Counters of an earlier instrumented run, found by the source position of the loops
+    if (profile_file != NULL)
+    {
+        size_t missing;
+
+        if ((status = profile_read(&profile, profile_file)) < 0)
+        {
+            profile_free(&profile);
+            if (emit != EMIT_NONE)
+            {
+                source_map_free(&map);
+            }
+            program_free(&program);
+            return -status;
+        }
+
+        if ((missing = profile_missing(&profile, &program)) > 0)
+        {
+            fprintf(stderr, "Warning: %s has no counts for %zu loops, was it made from another program or with other options?\n", profile_file, missing);
+        }
+
+        compile_options.profile = &profile;
+    }
+
+    if (emit == EMIT_IR)
+    {
+        print_ir(stdout, &program, &map, compile_options.profile);
+        if (profile_file != NULL)
+        {
+            profile_free(&profile);
+        }
+        source_map_free(&map);
+        program_free(&program);
+        return 0;
+    }
+
+    // Run the program without generating any code
+    if (interpret)
+    {
+        if (show_stats)
+        {
+            print_stats(stderr, &stats);
+        }
+
+        status = interpret_program(&program, &compile_options);
+        program_free(&program);
+        if (profile_file != NULL)
+        {
+            profile_free(&profile);
+        }
+        return status < 0 ? -status : status;
+    }
+
+    // Compile and run in this process, skipping the executable altogether
+    if (run)
+    {
+        status = run_program(&program, page_size, host_format->target, &compile_options, &stats);
+        program_free(&program);
+        if (profile_file != NULL)
+        {
+            profile_free(&profile);
+        }
+
+        if (show_stats)
+        {
+            print_stats(stderr, &stats);
+        }
+
+        return status < 0 ? -status : status;
+    }
+
+    // Listings need to know where the code of every instruction starts
+    if (emit == EMIT_ASM)
+    {
+        addresses = (uint32_t*) malloc((program.length + 2) * sizeof(uint32_t));
+        if (addresses == NULL)
+        {
+            if (profile_file != NULL)
+            {
+                profile_free(&profile);
+            }
+            source_map_free(&map);
+            program_free(&program);
+            fprintf(stderr, "Out of memory\n");
+            return ENOMEM;
+        }
+    }
+
+    // Compile program to bytecode
+    start = stats_clock();
+    status = compile(&program, &code, DATA_ADDR, format->target, &compile_options, addresses);
+    if (status == 0 && emit == EMIT_ASM)
+    {
+        print_asm(stdout, &program, &code, addresses, &map);
+    }
+
+    if (emit == EMIT_ASM)
+    {
+        free(addresses);
+        source_map_free(&map);
+    }
+    program_free(&program);
+
+    if (profile_file != NULL)
+    {
+        profile_free(&profile);
+    }
+
+    stats.codegen = 1;
+    stats.codegen_time = stats_clock() - start;
+    stats.code_size = code.size;
+    if (show_stats)
+    {
+        print_stats(stderr, &stats);
+    }
+
     if (status < 0)
     {
-        free_page_list(page_list);
-        free_token_string(token_string);
+        buffer_free(&code);
         fprintf(stderr, "Failed to compile to byte code\n");
         return -status;
     }
 
-    // Open output file for writing Mach-O executable
-    if ((stream = fopen(argv[2], "w")) == NULL)
+    if (emit == EMIT_ASM)
+    {
+        buffer_free(&code);
+        return 0;
+    }
+
+    // Open output file for writing executable
+    if ((fd = open(executable_file, O_WRONLY | O_CREAT | O_TRUNC, 0755)) < 0)
     {
-        fprintf(stderr, "Could not open file for write: %s\n", argv[2]);
+        buffer_free(&code);
+        fprintf(stderr, "Could not open file for write: %s\n", executable_file);
         return errno;
     }
 
-    // Write Mach-O executable
-    status = write_executable(stream, page_list, page_size, DATA_ADDR, TEXT_ADDR);
+    // Write executable and make it runnable
+    // Code goes right after the tape's upper guard region
+    status = format->write_executable(fd, &code, page_size, DATA_ADDR, DATA_ADDR + DATA_SIZE(compile_options.tape_size));
+    buffer_free(&code);
     if (status < 0)
     {
-        fclose(stream);
-        free_page_list(page_list);
-        free_token_string(token_string);
+        close(fd);
         fprintf(stderr, "Could not write to executable\n");
         return -status;
     }
 
-    fclose(stream);
+    close(fd);
+    chmod(executable_file, 0755);
     
     return 0;
 }
@@ -0,0 +1,662 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "ir.h"
+#include "optimizer.h"
+
+
+/* Largest number of cells a multiplication loop may touch */
+#define MAX_TARGETS     32
+
+
+/* Largest number of cells the dataflow analysis keeps facts about */
+#define MAX_FACTS       64
+
+
+/* Fact for a cell whose value is not known, or whose value is still needed */
+#define CELL_UNKNOWN    -1
+
+
+/* Fact for a cell whose value is overwritten before it is read */
+#define CELL_DEAD       0
+
+
+/* Match loop instructions again after the program has been rewritten */
+static int match_loops(struct program* program)
+{
+    size_t depth = 0;
+
+    uint32_t* loops = (uint32_t*) malloc((program->length / 2 + 1) * sizeof(uint32_t));
+    if (loops == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr* instr = &program->instrs[index];
+
+        switch (instr->opcode)
+        {
+            case OP_LOOP_BEGIN:
+                loops[depth++] = index;
+                break;
+
+            case OP_LOOP_END:
+                instr->match = loops[--depth];
+                program->instrs[instr->match].match = index;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    free(loops);
+    return 0;
+}
+
+
+/* Loop is [-] or [+], or any other odd step that is guaranteed to wrap around to zero */
+static int is_clear_loop(const struct program* program, size_t index)
+{
+    const struct instr* instrs = program->instrs + index;
+
+    return index + 2 < program->length
+        && instrs[0].opcode == OP_LOOP_BEGIN
+        && instrs[1].opcode == OP_ADD
+        && instrs[1].offset == 0
+        && (instrs[1].count & 1) == 1
+        && instrs[2].opcode == OP_LOOP_END;
+}
+
+
+int optimize_clear_loops(struct program* program)
+{
+    struct instr* instrs = program->instrs;
+    size_t length = 0;
+
+    // Instructions are only ever removed, so the program is rewritten in place
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr instr = instrs[index];
+
+        if (is_clear_loop(program, index))
+        {
+            instr.opcode = OP_SET;
+            instr.count = 0;
+            instr.offset = 0;
+            instr.match = 0;
+            index += 2;
+
+            /* Clear runs such as [-]>[-]>[-] become stores at increasing offsets
+             * with a single pointer move at the end
+             */
+            if (length >= 2 && instrs[length - 1].opcode == OP_MOVE && instrs[length - 2].opcode == OP_SET
+                    && instrs[length - 1].count >= -MAX_OFFSET && instrs[length - 1].count <= MAX_OFFSET)
+            {
+                instr.offset = instrs[length - 1].count;
+                instrs[length] = instrs[length - 1];
+                instrs[length - 1] = instr;
+                ++length;
+                continue;
+            }
+        }
+
+        // Merge with a move that was pushed past a clear
+        if (instr.opcode == OP_MOVE && length > 0 && instrs[length - 1].opcode == OP_MOVE)
+        {
+            instrs[length - 1].count += instr.count;
+            if (instrs[length - 1].count == 0)
+            {
+                --length;
+            }
+            continue;
+        }
+
+        instrs[length++] = instr;
+    }
+
+    program->length = length;
+    return match_loops(program);
+}
+
+
+/* Net effect of a multiplication loop on one cell */
+struct target_cell
+{
+    int32_t     offset;
+    int32_t     delta;
+};
+
+
+/* Find out if the loop starting at index is a multiplication loop
+ *
+ * That is a loop without I/O and nested loops, which ends up where it started
+ * and changes the current cell by exactly one each iteration. Returns the 
+ * number of cells touched (the loop cell is always the first one), or 0 if
+ * the loop is not a multiplication loop.
+ */
+static size_t find_targets(const struct program* program, size_t index, struct target_cell* targets)
+{
+    const struct instr* instr = &program->instrs[index];
+    size_t end = instr->match;
+    size_t count = 1;
+    int64_t position = 0;
+    int64_t cell;
+
+    targets[0].offset = 0;
+    targets[0].delta = 0;
+
+    for (++instr; instr != &program->instrs[end]; ++instr)
+    {
+        size_t target;
+
+        switch (instr->opcode)
+        {
+            case OP_MOVE:
+                position += instr->count;
+                break;
+
+            case OP_ADD:
+                cell = position + instr->offset;
+                if (cell < -MAX_OFFSET || cell > MAX_OFFSET)
+                {
+                    return 0;
+                }
+
+                for (target = 0; target < count && targets[target].offset != cell; ++target);
+
+                if (target == count)
+                {
+                    if (count == MAX_TARGETS)
+                    {
+                        return 0;
+                    }
+
+                    targets[count].offset = (int32_t) cell;
+                    targets[count].delta = 0;
+                    ++count;
+                }
+
+                targets[target].delta = (int32_t) ((uint32_t) targets[target].delta + (uint32_t) instr->count);
+                break;
+
+            default:
+                return 0;
+        }
+    }
+
+    if (position != 0 || (targets[0].delta != -1 && targets[0].delta != 1))
+    {
+        return 0;
+    }
+
+    return count;
+}
+
+
+int optimize_multiply_loops(struct program* program)
+{
+    struct instr* instrs = program->instrs;
+    struct target_cell targets[MAX_TARGETS];
+    size_t length = 0;
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        size_t end = instrs[index].match;
+        uint32_t position = instrs[index].position;
+        size_t count;
+
+        if (instrs[index].opcode != OP_LOOP_BEGIN || (count = find_targets(program, index, targets)) == 0)
+        {
+            instrs[length++] = instrs[index];
+            continue;
+        }
+
+        /* Loop runs as many times as the value of the loop cell, or its negation 
+         * if it counts upwards, so each target gets that times its delta
+         *
+         * The loop body is at least as long as the code replacing it,
+         * so the program can still be rewritten in place.
+         */
+        for (size_t target = 1; target < count; ++target)
+        {
+            if (targets[target].delta == 0)
+            {
+                continue;
+            }
+
+            struct instr* instr = &instrs[length++];
+            instr->opcode = OP_MUL;
+            instr->offset = targets[target].offset;
+            instr->source = 0;
+            instr->count = (int32_t) ((uint32_t) targets[target].delta * (uint32_t) -targets[0].delta);
+            instr->position = position;
+        }
+
+        struct instr* instr = &instrs[length++];
+        instr->opcode = OP_SET;
+        instr->offset = 0;
+        instr->count = 0;
+        instr->match = 0;
+        instr->position = position;
+
+        index = end;
+    }
+
+    program->length = length;
+    return match_loops(program);
+}
+
+
+int optimize_scan_loops(struct program* program)
+{
+    struct instr* instrs = program->instrs;
+    size_t length = 0;
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr instr = instrs[index];
+
+        if (instr.opcode == OP_LOOP_BEGIN && instr.match == index + 2 && instrs[index + 1].opcode == OP_MOVE)
+        {
+            instr.opcode = OP_SCAN;
+            instr.count = instrs[index + 1].count;
+            instr.offset = 0;
+            instr.match = 0;
+            index += 2;
+        }
+
+        instrs[length++] = instr;
+    }
+
+    program->length = length;
+    return match_loops(program);
+}
+
+
+/* Is the cell at offset plus distance no further away than MAX_OFFSET */
+static int in_reach(int32_t offset, int32_t distance)
+{
+    int64_t cell = (int64_t) offset + distance;
+    return cell >= -MAX_OFFSET && cell <= MAX_OFFSET;
+}
+
+
+/* Emit a move for the offset that has built up, if any, attributed to the first move folded into it */
+static void flush_pending_move(struct instr* instrs, size_t* length, int32_t* pending, uint32_t position)
+{
+    if (*pending != 0)
+    {
+        struct instr* instr = &instrs[(*length)++];
+        instr->opcode = OP_MOVE;
+        instr->count = *pending;
+        instr->offset = 0;
+        instr->match = 0;
+        instr->position = position;
+        *pending = 0;
+    }
+}
+
+
+int optimize_pointer_moves(struct program* program)
+{
+    struct instr* instrs = program->instrs;
+    size_t length = 0;
+    int32_t pending = 0;
+    uint32_t position = 0;
+
+    /* A pending move is only flushed after at least one move has been dropped,
+     * so the program can still be rewritten in place.
+     */
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr instr = instrs[index];
+
+        switch (instr.opcode)
+        {
+            case OP_MOVE:
+                if (in_reach(pending, instr.count))
+                {
+                    position = pending != 0 ? position : instr.position;
+                    pending += instr.count;
+                    continue;
+                }
+
+                // Too far to fold into an offset, so the pointer has to move
+                flush_pending_move(instrs, &length, &pending, position);
+                break;
+
+            case OP_MUL:
+                if (!in_reach(instr.source, pending) || !in_reach(instr.offset, pending))
+                {
+                    flush_pending_move(instrs, &length, &pending, position);
+                }
+
+                instr.source += pending;
+                instr.offset += pending;
+                break;
+
+            case OP_ADD:
+            case OP_SET:
+            case OP_WRITE:
+            case OP_READ:
+                if (!in_reach(instr.offset, pending))
+                {
+                    flush_pending_move(instrs, &length, &pending, position);
+                }
+
+                instr.offset += pending;
+                break;
+
+            default:
+                // Loops and scans test the current cell, so the pointer has to be where they expect it
+                flush_pending_move(instrs, &length, &pending, position);
+                break;
+        }
+
+        instrs[length++] = instr;
+    }
+
+    // The exit status is the value of the current cell
+    flush_pending_move(instrs, &length, &pending, position);
+
+    program->length = length;
+    return match_loops(program);
+}
+
+
+/* What is known about one cell, relative to the cell pointer */
+struct cell_fact
+{
+    int32_t     offset;
+    int64_t     fact;
+};
+
+
+/* What is known about the tape at one point in the program
+ *
+ * Cells that are not in the table have the fallback fact. The forward
+ * analysis stores cell values (wrapped to the cell width), the backward 
+ * analysis stores whether a cell is dead. CELL_UNKNOWN is the safe choice
+ * for both; for 64-bit cells it doubles as the value -1, which is then
+ * simply never known.
+ */
+struct tape_state
+{
+    int64_t             fallback;
+    size_t              count;
+    struct cell_fact    cells[MAX_FACTS];
+};
+
+
+static void reset_facts(struct tape_state* state, int64_t fallback)
+{
+    state->fallback = fallback;
+    state->count = 0;
+}
+
+
+static int64_t get_fact(const struct tape_state* state, int32_t offset)
+{
+    for (size_t index = 0; index < state->count; ++index)
+    {
+        if (state->cells[index].offset == offset)
+        {
+            return state->cells[index].fact;
+        }
+    }
+
+    return state->fallback;
+}
+
+
+static void set_fact(struct tape_state* state, int32_t offset, int64_t fact)
+{
+    for (size_t index = 0; index < state->count; ++index)
+    {
+        if (state->cells[index].offset == offset)
+        {
+            state->cells[index].fact = fact;
+            return;
+        }
+    }
+
+    // Forgetting everything is always safe
+    if (state->count == MAX_FACTS)
+    {
+        reset_facts(state, CELL_UNKNOWN);
+    }
+
+    state->cells[state->count].offset = offset;
+    state->cells[state->count].fact = fact;
+    ++state->count;
+}
+
+
+/* The cell pointer moved, so every cell is now at a different offset */
+static void shift_facts(struct tape_state* state, int32_t distance)
+{
+    for (size_t index = 0; index < state->count; ++index)
+    {
+        state->cells[index].offset -= distance;
+    }
+}
+
+
+/* Value a cell of the given width ends up with, as a number from 0 to 2^bits - 1
+ *
+ * The arithmetic is done modulo 2^64, so 64-bit cells are left as they are.
+ */
+static int64_t wrap_value(uint64_t value, int cell_bits)
+{
+    return (int64_t) (cell_bits < 64 ? value & ((UINT64_C(1) << cell_bits) - 1) : value);
+}
+
+
+/* Can the value be stored with an instruction count
+ *
+ * Counts are sign-extended to the cell width, so for 64-bit cells 
+ * the value has to fit in 32 bits.
+ */
+static int fits_count(int64_t value, int cell_bits)
+{
+    return cell_bits < 64 || (value >= INT32_MIN && value <= INT32_MAX);
+}
+
+
+/* Track known cell values from the start of the program, where the tape is all zeroes
+ *
+ * Loops whose cell is known to be zero are removed, additions to known 
+ * cells become stores and multiplications by known cells become additions 
+ * or stores.
+ */
+static void propagate_constants(struct program* program, int cell_bits)
+{
+    struct instr* instrs = program->instrs;
+    struct tape_state state;
+    size_t length = 0;
+    int64_t value;
+    int64_t source;
+    int64_t product;
+
+    reset_facts(&state, 0);
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr instr = instrs[index];
+
+        switch (instr.opcode)
+        {
+            case OP_MOVE:
+                shift_facts(&state, instr.count);
+                break;
+
+            case OP_ADD:
+                value = get_fact(&state, instr.offset);
+                if (value != CELL_UNKNOWN)
+                {
+                    value = wrap_value((uint64_t) value + (uint64_t) (int64_t) instr.count, cell_bits);
+                    if (fits_count(value, cell_bits))
+                    {
+                        instr.opcode = OP_SET;
+                        instr.count = (int32_t) value;
+                    }
+                    set_fact(&state, instr.offset, value);
+                }
+                break;
+
+            case OP_SET:
+                set_fact(&state, instr.offset, wrap_value((uint64_t) (int64_t) instr.count, cell_bits));
+                break;
+
+            case OP_MUL:
+                source = get_fact(&state, instr.source);
+                value = get_fact(&state, instr.offset);
+                if (source == CELL_UNKNOWN)
+                {
+                    set_fact(&state, instr.offset, CELL_UNKNOWN);
+                    break;
+                }
+
+                product = wrap_value((uint64_t) source * (uint64_t) (int64_t) instr.count, cell_bits);
+                if (product == 0)
+                {
+                    continue;
+                }
+
+                if (value != CELL_UNKNOWN)
+                {
+                    value = wrap_value((uint64_t) value + (uint64_t) product, cell_bits);
+                    if (fits_count(value, cell_bits))
+                    {
+                        instr.opcode = OP_SET;
+                        instr.count = (int32_t) value;
+                        instr.source = 0;
+                    }
+                    set_fact(&state, instr.offset, value);
+                }
+                else if (fits_count(product, cell_bits))
+                {
+                    instr.opcode = OP_ADD;
+                    instr.count = (int32_t) product;
+                    instr.source = 0;
+                }
+                break;
+
+            case OP_READ:
+                set_fact(&state, instr.offset, CELL_UNKNOWN);
+                break;
+
+            case OP_LOOP_BEGIN:
+                if (get_fact(&state, 0) == 0)
+                {
+                    // Loop is never entered
+                    index = instr.match;
+                    continue;
+                }
+
+                // Loop body may run any number of times
+                reset_facts(&state, CELL_UNKNOWN);
+                break;
+
+            case OP_LOOP_END:
+            case OP_SCAN:
+                if (instr.opcode == OP_SCAN && get_fact(&state, 0) == 0)
+                {
+                    // Scan stops right away
+                    continue;
+                }
+
+                reset_facts(&state, CELL_UNKNOWN);
+                set_fact(&state, 0, 0);
+                break;
+
+            default:
+                break;
+        }
+
+        instrs[length++] = instr;
+    }
+
+    program->length = length;
+}
+
+
+/* Remove stores and additions to cells that are overwritten before they are read
+ *
+ * The program is walked backwards, so the instructions that are kept are
+ * moved to the end of the array and then back to the front.
+ */
+static void remove_dead_stores(struct program* program)
+{
+    struct instr* instrs = program->instrs;
+    struct tape_state state;
+    size_t first = program->length;
+
+    // The exit status is the value of the current cell
+    reset_facts(&state, CELL_DEAD);
+    set_fact(&state, 0, CELL_UNKNOWN);
+
+    for (size_t index = program->length; index-- > 0; )
+    {
+        struct instr instr = instrs[index];
+
+        switch (instr.opcode)
+        {
+            case OP_MOVE:
+                shift_facts(&state, -instr.count);
+                break;
+
+            case OP_SET:
+                if (get_fact(&state, instr.offset) == CELL_DEAD)
+                {
+                    continue;
+                }
+                set_fact(&state, instr.offset, CELL_DEAD);
+                break;
+
+            case OP_ADD:
+                if (get_fact(&state, instr.offset) == CELL_DEAD)
+                {
+                    continue;
+                }
+                break;
+
+            case OP_MUL:
+                if (get_fact(&state, instr.offset) == CELL_DEAD)
+                {
+                    continue;
+                }
+                set_fact(&state, instr.source, CELL_UNKNOWN);
+                break;
+
+            case OP_WRITE:
+            case OP_READ:
+                // A read at end of file may leave the cell as it was
+                set_fact(&state, instr.offset, CELL_UNKNOWN);
+                break;
+
+            default:
+                reset_facts(&state, CELL_UNKNOWN);
+                break;
+        }
+
+        instrs[--first] = instr;
+    }
+
+    program->length -= first;
+    memmove(instrs, instrs + first, program->length * sizeof(struct instr));
+}
+
+
+int optimize_dataflow(struct program* program, int cell_bits)
+{
+    propagate_constants(program, cell_bits);
+    remove_dead_stores(program);
+    return match_loops(program);
+}
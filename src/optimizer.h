@@ -0,0 +1,29 @@
+#ifndef __OPTIMIZER_H__
+#define __OPTIMIZER_H__
+
+#include "ir.h"
+
+
+/* Replace loops that only count the current cell down (or up) to zero with a store */
+int optimize_clear_loops(struct program* program);
+
+
+/* Replace loops that move values to other cells, like [->+>+++<<], with multiplications */
+int optimize_multiply_loops(struct program* program);
+
+
+/* Replace loops that only move the cell pointer, like [>] and [<<], with scans for a zero cell */
+int optimize_scan_loops(struct program* program);
+
+
+/* Remove loops over cells known to be zero, fold known cell values into stores and remove dead stores
+ *
+ * Cell values wrap around at the given cell width in bits.
+ */
+int optimize_dataflow(struct program* program, int cell_bits);
+
+
+/* Fold pointer moves into the offsets of the instructions that follow them, moving the pointer only at loops */
+int optimize_pointer_moves(struct program* program);
+
+#endif
@@ -1,188 +1,318 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "token.h"
+#include "ir.h"
 #include "parser.h"
 
 
-static struct token* create_token(enum symbol command, size_t size)
+/* Is the byte one of the eight Brainfuck commands */
+static int is_symbol(unsigned char byte)
 {
-    struct token* token = (struct token*) malloc(size);
+    switch (byte)
+    {
+        case LOOP_BEGIN:
+        case LOOP_END:
+        case INCR_DATA:
+        case DECR_DATA:
+        case INCR_CELL:
+        case DECR_CELL:
+        case WRITE_DATA:
+        case READ_DATA:
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+
+/* Fold a '+', '-', '>' or '<' into the previous instruction if it is of the same kind */
+static int add_to_run(struct program* program, enum opcode opcode, int32_t count, uint32_t position)
+{
+    struct instr* prev = program->length > 0 ? &program->instrs[program->length - 1] : NULL;
 
-    if (token == NULL)
+    if (prev != NULL && prev->opcode == opcode)
     {
-        fprintf(stderr, "Out of memory\n");
-        return NULL;
+        prev->count = (int32_t) ((uint32_t) prev->count + (uint32_t) count);
+
+        // Run cancelled itself out, for example +- or <>
+        if (prev->count == 0)
+        {
+            --program->length;
+        }
+
+        return 0;
     }
 
-    memset(token, 0, size);
-    token->symbol = command;
-    token->next = NULL;
-    token->size = size;
+    prev = program_append(program, opcode);
+    if (prev == NULL)
+    {
+        return -ENOMEM;
+    }
 
-    return token;
+    prev->count = count;
+    prev->position = position;
+    return 0;
 }
 
 
-static struct token* get_next_token(FILE* stream)
+/* Append the instruction for a command, folding it into the previous one where possible */
+static int add_symbol(struct program* program, int symbol, uint32_t position)
 {
-    int byte;
+    struct instr* instr;
 
-    while ((byte = fgetc(stream)) != -1)
+    switch (symbol)
     {
-        switch (byte)
-        {
-            case LOOP_BEGIN:
-            case LOOP_END:
-                return create_token((enum symbol) byte, sizeof(struct loop));
-
-            case INCR_DATA:
-            case DECR_DATA:
-            case INCR_CELL:
-            case DECR_CELL:
-            case WRITE_DATA:
-            case READ_DATA:
-                return create_token((enum symbol) byte, sizeof(struct token));
+        case INCR_DATA:
+            return add_to_run(program, OP_ADD, 1, position);
 
-            default:
-                // do nothing
-                break;
-        }
+        case DECR_DATA:
+            return add_to_run(program, OP_ADD, -1, position);
+
+        case INCR_CELL:
+            return add_to_run(program, OP_MOVE, 1, position);
+
+        case DECR_CELL:
+            return add_to_run(program, OP_MOVE, -1, position);
+
+        case LOOP_BEGIN:
+            instr = program_append(program, OP_LOOP_BEGIN);
+            break;
+
+        case LOOP_END:
+            instr = program_append(program, OP_LOOP_END);
+            break;
+
+        case WRITE_DATA:
+            instr = program_append(program, OP_WRITE);
+            break;
+
+        case READ_DATA:
+            instr = program_append(program, OP_READ);
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (instr == NULL)
+    {
+        return -ENOMEM;
     }
 
-    return NULL;
+    instr->position = position;
+    return 0;
+}
+
+
+#ifdef __SSE2__
+/* Find the commands among 16 bytes of source, one bit per byte */
+static unsigned find_symbols(const unsigned char* source)
+{
+    __m128i bytes = _mm_loadu_si128((const __m128i*) source);
+
+    // '+', ',', '-' and '.' are next to each other, so one unsigned range check covers them
+    __m128i range = _mm_sub_epi8(bytes, _mm_set1_epi8(INCR_DATA));
+    __m128i found = _mm_cmpeq_epi8(_mm_min_epu8(range, _mm_set1_epi8(3)), range);
+
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(INCR_CELL)));
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(DECR_CELL)));
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(LOOP_BEGIN)));
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(LOOP_END)));
+
+    return (unsigned) _mm_movemask_epi8(found);
 }
+#endif
 
 
-int tokenize_file(FILE* input_file, struct token** token_string)
+/* Pass through the source once, picking out the commands and folding runs as they are found */
+static int tokenize(const unsigned char* source, size_t size, struct program* program, size_t* tokens)
 {
-    struct token* prev_token = NULL;
-    struct token* curr_token = NULL;
+    size_t pos = 0;
+    int status;
 
-    while ((curr_token = get_next_token(input_file)) != NULL)
+#ifdef __SSE2__
+    // Comments and whitespace are skipped 16 bytes at a time
+    for (; pos + 16 <= size; pos += 16)
     {
-        if (prev_token == NULL)
-        {
-            *token_string = prev_token = curr_token;
-        }
-        else
+        unsigned mask = find_symbols(source + pos);
+
+        while (mask != 0)
         {
-            prev_token->next = curr_token;
-            prev_token = curr_token;
+            status = add_symbol(program, source[pos + __builtin_ctz(mask)], (uint32_t) (pos + __builtin_ctz(mask)));
+            if (status < 0)
+            {
+                return status;
+            }
+
+            ++*tokens;
+            mask &= mask - 1;
         }
     }
+#endif
 
-    if (prev_token == NULL)
+    for (; pos < size; ++pos)
     {
-        fprintf(stderr, "No tokens found\n");
-        return -1;
+        if (is_symbol(source[pos]))
+        {
+            status = add_symbol(program, source[pos], (uint32_t) pos);
+            if (status < 0)
+            {
+                return status;
+            }
+
+            ++*tokens;
+        }
     }
 
     return 0;
 }
 
 
-static struct token* find_loop_end(struct token* token, size_t loop_stack)
+/* Read all of a stream that can not be mapped, such as a pipe */
+static unsigned char* read_stream(FILE* stream, size_t* size)
 {
-    while (token != NULL)
-    {
-        switch (token->symbol)
-        {
-            case LOOP_BEGIN:
-                ++loop_stack;
-                break;
+    size_t capacity = 1 << 16;
+    unsigned char* buffer = malloc(capacity);
+    size_t bytes;
 
-            case LOOP_END:
-                if (--loop_stack == 0)
-                {
-                    return token;
-                }
-                break;
+    *size = 0;
 
-            default:
-                // do nothing
-                break;
-        }
+    while (buffer != NULL && (bytes = fread(buffer + *size, 1, capacity - *size, stream)) > 0)
+    {
+        *size += bytes;
 
-        token = token->next;
+        if (*size == capacity)
+        {
+            unsigned char* larger = realloc(buffer, capacity * 2);
+            if (larger == NULL)
+            {
+                free(buffer);
+                return NULL;
+            }
+
+            buffer = larger;
+            capacity *= 2;
+        }
     }
 
-    return NULL;
+    return buffer;
 }
 
 
-static struct token* calculate_move_chain(struct move* token)
+int tokenize_file(FILE* input_file, struct program* program)
 {
-    struct token* curr_token = (struct token*) token; 
-    struct token* prev_token = NULL;
-    int move = 0;
+    int status;
+    size_t tokens = 0;
+    struct stat info;
+    unsigned char* source = NULL;
+    size_t size = 0;
+    int mapped = 0;
+
+    status = program_init(program, 4096);
+    if (status < 0)
+    {
+        return status;
+    }
 
-    while (curr_token != NULL)
+    // Map regular files, there is no need to copy the source through stdio
+    if (fstat(fileno(input_file), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
     {
-        switch (curr_token->symbol)
+        size = (size_t) info.st_size;
+        source = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(input_file), 0);
+        mapped = source != MAP_FAILED;
+    }
+
+    if (!mapped)
+    {
+        source = read_stream(input_file, &size);
+        if (source == NULL)
         {
-            case INCR_CELL:
-                ++move;
+            fprintf(stderr, "Out of memory\n");
+            return -ENOMEM;
+        }
+    }
 
-                break;
-                
-            case DECR_CELL:
-                --move;
-                break;
+    status = tokenize(source, size, program, &tokens);
 
-            default:
-                return prev_token;
-        }
+    if (mapped)
+    {
+        munmap(source, size);
+    }
+    else
+    {
+        free(source);
+    }
+
+    if (status < 0)
+    {
+        return status;
+    }
 
-        prev_token = curr_token;
-        curr_token = curr_token->next;
+    if (tokens == 0)
+    {
+        fprintf(stderr, "No tokens found\n");
+        return -1;
     }
 
-    return NULL;
+    return 0;
 }
 
 
-int parse(struct token* token_string)
+int parse(struct program* program)
 {
-    struct token* curr_token = token_string;
-    int64_t nest_count = 0;
-    
-    while (curr_token != NULL)
-    {
-        switch (curr_token->symbol)
-        {
-            case LOOP_BEGIN:
-                if (++nest_count >= INT64_MAX)
-                {
-                    fprintf(stderr, "Excessive loop nesting\n");
-                    return -1;
-                }
+    size_t depth = 0;
 
-                ((struct loop*) curr_token)->match = find_loop_end(curr_token, 0);
+    // Every unmatched '[' is on the stack, so it can never be deeper than the program is long
+    uint32_t* loops = (uint32_t*) malloc((program->length + 1) * sizeof(uint32_t));
+    if (loops == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
 
-                if (((struct loop*) curr_token)->match == NULL)
-                {
-                    fprintf(stderr, "Matching ']' not found, searched past end of file\n");
-                    return -2;
-                }
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        struct instr* instr = &program->instrs[index];
 
-                ((struct loop*) ((struct loop*) curr_token)->match)->match = curr_token;
+        switch (instr->opcode)
+        {
+            case OP_LOOP_BEGIN:
+                loops[depth++] = (uint32_t) index;
                 break;
 
-            case LOOP_END:
-                if (--nest_count < 0 || ((struct loop*) curr_token)->match == NULL)
+            case OP_LOOP_END:
+                if (depth == 0)
                 {
+                    free(loops);
                     fprintf(stderr, "Rogue ']'\n");
                     return -3;
                 }
+
+                instr->match = loops[--depth];
+                program->instrs[instr->match].match = (uint32_t) index;
                 break;
 
             default:
                 break;
         }
+    }
 
-        curr_token = curr_token->next;
+    free(loops);
+
+    if (depth != 0)
+    {
+        fprintf(stderr, "Matching ']' not found, searched past end of file\n");
+        return -2;
     }
 
     return 0;
@@ -2,14 +2,14 @@
 #define __PARSER_H__
 
 #include <stdio.h>
-#include "token.h"
+#include "ir.h"
 
 
-/* Pass through the input file and create a string of tokens */
-int tokenize_file(FILE* input_file, struct token** token_string);
+/* Pass through the input file and create the program, folding runs of commands */
+int tokenize_file(FILE* input_file, struct program* program);
 
 
-/* Pass through the string of tokens and build the parse tree */
-int parse(struct token* token_string);
+/* Pass through the program and match loops */
+int parse(struct program* program);
 
 #endif
@@ -0,0 +1,200 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "ir.h"
+#include "optimizer.h"
+#include "passes.h"
+
+
+static int run_clear_loops(struct program* program, const struct options* options)
+{
+    (void) options;
+    return optimize_clear_loops(program);
+}
+
+
+static int run_multiply_loops(struct program* program, const struct options* options)
+{
+    (void) options;
+    return optimize_multiply_loops(program);
+}
+
+
+static int run_scan_loops(struct program* program, const struct options* options)
+{
+    (void) options;
+    return optimize_scan_loops(program);
+}
+
+
+static int run_dataflow(struct program* program, const struct options* options)
+{
+    return optimize_dataflow(program, options->cell_bits);
+}
+
+
+static int run_pointer_moves(struct program* program, const struct options* options)
+{
+    (void) options;
+    return optimize_pointer_moves(program);
+}
+
+
+const struct pass passes[PASSES] =
+{
+    [PASS_CLEAR_LOOPS] = { "clear-loops", 1, run_clear_loops },
+    [PASS_MULTIPLY_LOOPS] = { "multiply-loops", 2, run_multiply_loops },
+    [PASS_SCAN_LOOPS] = { "scan-loops", 2, run_scan_loops },
+    [PASS_DATAFLOW] = { "dataflow", 2, run_dataflow },
+    [PASS_POINTER_MOVES] = { "pointer-moves", 1, run_pointer_moves },
+    [PASS_CELL_REGISTERS] = { "cell-registers", 1, NULL },
+    [PASS_ROTATE_LOOPS] = { "rotate-loops", 1, NULL },
+    [PASS_VECTOR_ADDS] = { "vector-adds", 2, NULL }
+};
+
+
+uint64_t stats_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+
+int find_pass(const char* name)
+{
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        if (strcmp(passes[pass].name, name) == 0)
+        {
+            return pass;
+        }
+    }
+
+    return -1;
+}
+
+
+unsigned passes_for_level(int level)
+{
+    unsigned enabled = 0;
+
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        if (passes[pass].level <= level)
+        {
+            enabled |= 1U << pass;
+        }
+    }
+
+    return enabled;
+}
+
+
+int run_passes(struct program* program, unsigned enabled, struct options* options, struct stats* stats)
+{
+    options->cell_registers = (enabled >> PASS_CELL_REGISTERS) & 1;
+    options->rotate_loops = (enabled >> PASS_ROTATE_LOOPS) & 1;
+    options->vector_adds = (enabled >> PASS_VECTOR_ADDS) & 1;
+
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        size_t before = program->length;
+        uint64_t start;
+        int status;
+
+        if (!(enabled & (1U << pass)))
+        {
+            continue;
+        }
+
+        // Their effect shows in the time and size of the code generation
+        if (passes[pass].run == NULL)
+        {
+            if (stats != NULL)
+            {
+                stats->passes[pass].enabled = 1;
+            }
+            continue;
+        }
+
+        start = stats_clock();
+        status = passes[pass].run(program, options);
+        if (status < 0)
+        {
+            return status;
+        }
+
+        if (stats != NULL)
+        {
+            stats->passes[pass].enabled = 1;
+            stats->passes[pass].time = stats_clock() - start;
+            stats->passes[pass].before = before;
+            stats->passes[pass].after = program->length;
+        }
+    }
+
+    return 0;
+}
+
+
+/* Peak resident memory of the process in kilobytes */
+static long peak_memory(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return -1;
+    }
+
+#ifdef __APPLE__
+    // Reported in bytes on macOS, but in kilobytes on Linux
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+
+void print_stats(FILE* stream, const struct stats* stats)
+{
+    fprintf(stream, "{\n");
+    fprintf(stream, "  \"level\": %d,\n", stats->level);
+    fprintf(stream, "  \"tokenize\": { \"time_us\": %.3f, \"instrs\": %zu },\n", stats->tokenize_time / 1e3, stats->tokens);
+    fprintf(stream, "  \"parse\": { \"time_us\": %.3f },\n", stats->parse_time / 1e3);
+    fprintf(stream, "  \"passes\": [\n");
+
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        const struct pass_stats* ps = &stats->passes[pass];
+
+        fprintf(stream, "    { \"name\": \"%s\", \"enabled\": %s", passes[pass].name, ps->enabled ? "true" : "false");
+        if (passes[pass].run == NULL)
+        {
+            fprintf(stream, ", \"stage\": \"codegen\"");
+        }
+        else if (ps->enabled)
+        {
+            fprintf(stream, ", \"time_us\": %.3f, \"instrs_before\": %zu, \"instrs_after\": %zu", ps->time / 1e3, ps->before, ps->after);
+        }
+        fprintf(stream, " }%s\n", pass + 1 < PASSES ? "," : "");
+    }
+
+    fprintf(stream, "  ],\n");
+    if (stats->codegen)
+    {
+        fprintf(stream, "  \"codegen\": { \"time_us\": %.3f, \"code_size\": %zu },\n", stats->codegen_time / 1e3, stats->code_size);
+    }
+    else
+    {
+        fprintf(stream, "  \"codegen\": null,\n");
+    }
+    fprintf(stream, "  \"peak_memory_kb\": %ld\n", peak_memory());
+    fprintf(stream, "}\n");
+}
@@ -0,0 +1,93 @@
+#ifndef __PASSES_H__
+#define __PASSES_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ir.h"
+#include "compiler.h"
+
+
+/* Optimisation passes, in the order they run
+ *
+ * The last ones are applied by the code generator rather than to the
+ * program, and only switch options of the code generation.
+ */
+enum pass_id
+{
+    PASS_CLEAR_LOOPS,
+    PASS_MULTIPLY_LOOPS,
+    PASS_SCAN_LOOPS,
+    PASS_DATAFLOW,
+    PASS_POINTER_MOVES,
+    PASS_CELL_REGISTERS,
+    PASS_ROTATE_LOOPS,
+    PASS_VECTOR_ADDS,
+    PASSES
+};
+
+
+/* Optimisation levels */
+#define MAX_LEVEL       3       // highest level -O accepts
+#define DEFAULT_LEVEL   2       // level used when no -O is given
+
+
+/* Optimisation pass of the pipeline */
+struct pass
+{
+    const char*     name;       // name used by -f<name>, -fno-<name> and the statistics
+    int             level;      // lowest optimisation level that runs the pass
+    int (*run)(struct program*, const struct options*);    // NULL when the code generator applies it
+};
+
+
+extern const struct pass passes[PASSES];
+
+
+/* What one pass did to the program */
+struct pass_stats
+{
+    int             enabled;    // the pass ran, or the code generator applies it
+    uint64_t        time;       // time it took, in nanoseconds
+    size_t          before;     // number of instructions before the pass
+    size_t          after;      // number of instructions after the pass
+};
+
+
+/* Statistics of one compilation, collected for --stats */
+struct stats
+{
+    int                 level;          // optimisation level
+    uint64_t            tokenize_time;  // time spent reading the source, in nanoseconds
+    uint64_t            parse_time;     // time spent matching loops, in nanoseconds
+    size_t              tokens;         // number of instructions the source was folded into
+    struct pass_stats   passes[PASSES]; // statistics of every pass, indexed by pass
+    int                 codegen;        // machine code was generated
+    uint64_t            codegen_time;   // time spent generating code, in nanoseconds
+    size_t              code_size;      // number of bytes of code generated
+};
+
+
+/* Monotonic clock for the statistics, in nanoseconds */
+uint64_t stats_clock(void);
+
+
+/* Look up a pass by name, returns -1 if there is no such pass */
+int find_pass(const char* name);
+
+
+/* Passes that run at the given optimisation level, as a bit mask indexed by pass */
+unsigned passes_for_level(int level);
+
+
+/* Run the enabled passes over the program in pipeline order
+ *
+ * The passes of the code generator are turned on or off in the options.
+ * Statistics of every pass are recorded when stats is not NULL.
+ */
+int run_passes(struct program* program, unsigned enabled, struct options* options, struct stats* stats);
+
+
+/* Print the statistics as JSON, including the peak memory use of the process */
+void print_stats(FILE* stream, const struct stats* stats);
+
+#endif
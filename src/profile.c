@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include "ir.h"
+#include "profile.h"
+
+
+int profile_read(struct profile* profile, const char* path)
+{
+    struct profile_header header;
+    FILE* stream;
+
+    profile->loops = NULL;
+    profile->count = 0;
+    profile->busiest = 0;
+
+    if ((stream = fopen(path, "rb")) == NULL)
+    {
+        fprintf(stderr, "Could not open profile for read: %s\n", path);
+        return -errno;
+    }
+
+    if (fread(&header, sizeof(header), 1, stream) != 1 || header.magic != PROFILE_MAGIC || header.count > MAX_PROFILE_LOOPS)
+    {
+        fclose(stream);
+        fprintf(stderr, "Not a profile written by an instrumented program: %s\n", path);
+        return -EINVAL;
+    }
+
+    profile->loops = (struct loop_profile*) malloc((header.count + 1) * sizeof(struct loop_profile));
+    if (profile->loops == NULL)
+    {
+        fclose(stream);
+        fprintf(stderr, "Out of memory\n");
+        return -ENOMEM;
+    }
+
+    if (fread(profile->loops, sizeof(struct loop_profile), header.count, stream) != header.count)
+    {
+        fclose(stream);
+        fprintf(stderr, "Profile is truncated: %s\n", path);
+        return -EINVAL;
+    }
+
+    fclose(stream);
+    profile->count = header.count;
+
+    // Loops were numbered in program order, so their positions only go up
+    for (size_t loop = 0; loop < profile->count; ++loop)
+    {
+        if (loop > 0 && profile->loops[loop].position <= profile->loops[loop - 1].position)
+        {
+            fprintf(stderr, "Profile is corrupt: %s\n", path);
+            return -EINVAL;
+        }
+
+        if (profile->loops[loop].iterations > profile->busiest)
+        {
+            profile->busiest = profile->loops[loop].iterations;
+        }
+    }
+
+    return 0;
+}
+
+
+void profile_free(struct profile* profile)
+{
+    free(profile->loops);
+    profile->loops = NULL;
+    profile->count = 0;
+    profile->busiest = 0;
+}
+
+
+const struct loop_profile* profile_find(const struct profile* profile, uint32_t position)
+{
+    size_t low = 0;
+    size_t high = profile->count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (profile->loops[middle].position == position)
+        {
+            return &profile->loops[middle];
+        }
+
+        if (profile->loops[middle].position < position)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return NULL;
+}
+
+
+size_t profile_missing(const struct profile* profile, const struct program* program)
+{
+    size_t missing = 0;
+
+    for (size_t index = 0; index < program->length; ++index)
+    {
+        missing += program->instrs[index].opcode == OP_LOOP_BEGIN && profile_find(profile, program->instrs[index].position) == NULL;
+    }
+
+    return missing;
+}
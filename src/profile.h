@@ -0,0 +1,68 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+#include "ir.h"
+
+
+/* Profile written by programs compiled with --instrument
+ *
+ * The file is an image of the profile area of the data segment: a header
+ * with the magic number and the number of loops, followed by a record for
+ * every loop of the program, in program order. All fields are 64-bit and
+ * in the byte order of the machine the program ran on.
+ */
+#define PROFILE_MAGIC   0x31464f5250434642ULL   // "BFCPROF1"
+
+
+struct profile_header
+{
+    uint64_t    magic;
+    uint64_t    count;      // number of loop records that follow
+};
+
+
+/* Counters of a single loop */
+struct loop_profile
+{
+    uint64_t    position;   // byte offset of the '[' in the source
+    uint64_t    entries;    // how often the loop was reached from outside
+    uint64_t    iterations; // how often its body ran, over all entries
+};
+
+
+/* Counters of all loops of a program, sorted by position */
+struct profile
+{
+    struct loop_profile*    loops;
+    size_t                  count;
+    uint64_t                busiest;    // most iterations any loop ran
+};
+
+
+/* Most loops a profile can hold, limited by the room for them in the data segment */
+#define MAX_PROFILE_LOOPS   ((RUNTIME_SIZE - PROFILE - sizeof(struct profile_header)) / sizeof(struct loop_profile))
+
+
+/* Read a profile written by an instrumented program */
+int profile_read(struct profile* profile, const char* path);
+
+
+/* Release the memory held by the profile */
+void profile_free(struct profile* profile);
+
+
+/* Counters of the loop starting at the given source position, or NULL if it was not profiled */
+const struct loop_profile* profile_find(const struct profile* profile, uint32_t position);
+
+
+/* Number of loops of the program the profile has no counters for
+ *
+ * Anything but 0 means that the profile was made from another program, or
+ * with options that optimised it differently.
+ */
+size_t profile_missing(const struct profile* profile, const struct program* program);
+
+#endif
@@ -0,0 +1,38 @@
+#include "target.h"
+
+
+/* BSD system calls are prefixed with the UNIX class mask 0x2000000 */
+const struct target target_macos =
+{
+    .name = "macos",
+    .sys_read = 0x2000003,
+    .sys_write = 0x2000004,
+    .sys_exit = 0x2000001,
+    .sys_lseek = 0x20000c7,
+    .sys_mmap = 0x20000c5,
+    .sys_open = 0x2000005,
+    .sys_close = 0x2000006,
+    .map_anonymous = 0x1040,    // MAP_ANON | MAP_NORESERVE
+    .open_create = 0x601,       // O_WRONLY | O_CREAT | O_TRUNC
+    .carry_on_error = 1,
+    .exit_syscall = 0,
+    .map_tape = 1
+};
+
+
+const struct target target_linux =
+{
+    .name = "linux",
+    .sys_read = 0,
+    .sys_write = 1,
+    .sys_exit = 60,
+    .sys_lseek = 8,
+    .sys_mmap = 9,
+    .sys_open = 2,
+    .sys_close = 3,
+    .map_anonymous = 0x4020,    // MAP_ANONYMOUS | MAP_NORESERVE
+    .open_create = 0x241,       // O_WRONLY | O_CREAT | O_TRUNC
+    .carry_on_error = 0,
+    .exit_syscall = 1,
+    .map_tape = 1
+};
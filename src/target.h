@@ -0,0 +1,33 @@
+#ifndef __TARGET_H__
+#define __TARGET_H__
+
+#include <stdint.h>
+
+
+/* Operating system specifics the generated code depends on */
+struct target
+{
+    const char*     name;           // name used to select the target on the command line
+    uint32_t        sys_read;       // system call number for read()
+    uint32_t        sys_write;      // system call number for write()
+    uint32_t        sys_exit;       // system call number for exit()
+    uint32_t        sys_lseek;      // system call number for lseek()
+    uint32_t        sys_mmap;       // system call number for mmap()
+    uint32_t        sys_open;       // system call number for open()
+    uint32_t        sys_close;      // system call number for close()
+    uint32_t        map_anonymous;  // mmap() flags for zero-filled memory without swap reserved
+    uint32_t        open_create;    // open() flags to write a new file, replacing an existing one
+    int             carry_on_error; // system calls report errors by setting the carry flag
+    int             exit_syscall;   // terminate with exit() instead of returning to the loader
+    int             map_tape;       // map the tape at start-up, as the executable image does not
+};
+
+
+/* Mac OS X, started by dyld through LC_MAIN */
+extern const struct target target_macos;
+
+
+/* Linux, started directly by the kernel */
+extern const struct target target_linux;
+
+#endif